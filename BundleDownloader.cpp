@@ -9,6 +9,7 @@
 #include <mavsprintf.h>
 #include <conprint.h>
 #include "BundleDownloader.h"
+#include "MemoryTracker.h"
 
 BundleDownloader::BundleDownloader(BundleListener *bl):mSocket(this)
 {
@@ -21,6 +22,7 @@ void BundleDownloader::textBoxClosed(int result, int textLength)
 {
 	if(result == MA_TB_RES_OK)
 	{
+		MemoryTagScope scope(MEMTAG_NET);
 		mDownloader = new Downloader();
 		mDownloader->addDownloadListener(this);
 
@@ -0,0 +1,36 @@
+/*
+ * FrameSync.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include <ma.h>
+#include <GLES/gl.h>
+#include "FrameSync.h"
+
+FrameSync::FrameSync():
+	mFrameStart(0),
+	mSubmitEnd(0),
+	mSubmitTime(0),
+	mWaitTime(0)
+{
+}
+
+void FrameSync::beginFrame()
+{
+	mFrameStart = maGetMilliSecondCount();
+	mWaitTime = 0;
+}
+
+void FrameSync::endFrame()
+{
+	// Hand the commands to the GPU, but don't wait for them.
+	glFlush();
+	mSubmitEnd = maGetMilliSecondCount();
+	mSubmitTime = mSubmitEnd - mFrameStart;
+}
+
+void FrameSync::framePresented()
+{
+	mWaitTime += maGetMilliSecondCount() - mSubmitEnd;
+}
@@ -0,0 +1,58 @@
+/*
+ * FrameSync.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef FRAMESYNC_H_
+#define FRAMESYNC_H_
+
+/**
+ * Paces frame submission without stalling on glFinish.
+ *
+ * Commands are flushed at the end of a frame and the buffer swap
+ * is left to throttle us, so how many frames run ahead of the GPU
+ * is up to the driver. MoSync's GL binding has no fence extension
+ * to bound it ourselves.
+ *
+ * Also measures, per frame, the CPU time spent submitting GL
+ * commands and the time spent waiting for the GPU and present.
+ */
+class FrameSync
+{
+public:
+	FrameSync();
+
+	/**
+	 * Call before the first GL command of a frame.
+	 */
+	void beginFrame();
+
+	/**
+	 * Call after the last GL command of a frame, before presenting.
+	 */
+	void endFrame();
+
+	/**
+	 * Call once the frame has been handed to the display.
+	 */
+	void framePresented();
+
+	/**
+	 * Milliseconds spent issuing GL commands in the last frame.
+	 */
+	int getSubmitTime() const { return mSubmitTime; }
+
+	/**
+	 * Milliseconds spent waiting for the GPU and present in the last frame.
+	 */
+	int getWaitTime() const { return mWaitTime; }
+
+private:
+	int mFrameStart;
+	int mSubmitEnd;
+	int mSubmitTime;
+	int mWaitTime;
+};
+
+#endif /* FRAMESYNC_H_ */
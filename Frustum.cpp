@@ -0,0 +1,38 @@
+/*
+ * Frustum.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "Frustum.h"
+
+void Frustum::update(const float *viewProjection)
+{
+	const float *clip = viewProjection;
+	// Extract the planes from the rows of the combined matrix.
+	for(int i = 0; i < 3; i++)
+	{
+		for(int j = 0; j < 4; j++)
+		{
+			mPlanes[i * 2][j] = clip[j * 4 + 3] + clip[j * 4 + i];
+			mPlanes[i * 2 + 1][j] = clip[j * 4 + 3] - clip[j * 4 + i];
+		}
+	}
+}
+
+bool Frustum::isBoxVisible(const float *min, const float *max) const
+{
+	for(int i = 0; i < 6; i++)
+	{
+		const float *p = mPlanes[i];
+		// The corner of the box furthest along the plane normal.
+		float x = (p[0] >= 0) ? max[0] : min[0];
+		float y = (p[1] >= 0) ? max[1] : min[1];
+		float z = (p[2] >= 0) ? max[2] : min[2];
+		if(p[0] * x + p[1] * y + p[2] * z + p[3] < 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
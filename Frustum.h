@@ -0,0 +1,34 @@
+/*
+ * Frustum.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef FRUSTUM_H_
+#define FRUSTUM_H_
+
+/**
+ * The six clip planes of the camera's view volume, used to
+ * reject geometry on the CPU before it is submitted to GL.
+ */
+class Frustum
+{
+public:
+	/**
+	 * Rebuild the planes from the combined view-projection
+	 * matrix the renderer loads into GL.
+	 */
+	void update(const float *viewProjection);
+
+	/**
+	 * @return false if the axis aligned box is entirely
+	 * outside the frustum.
+	 */
+	bool isBoxVisible(const float *min, const float *max) const;
+
+private:
+	// a, b, c, d for left, right, bottom, top, near, far.
+	float mPlanes[6][4];
+};
+
+#endif /* FRUSTUM_H_ */
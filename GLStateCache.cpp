@@ -0,0 +1,207 @@
+/*
+ * GLStateCache.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include <ma.h>
+#include "GLStateCache.h"
+
+GLStateCache::GLStateCache():
+	mEliminatedCalls(0),
+	mIssuedCalls(0)
+{
+	invalidate();
+	resetCounters();
+}
+
+void GLStateCache::invalidate()
+{
+	mNumCaps = 0;
+	mNumArrays = 0;
+	mTextureKnown = false;
+	mTexture = 0;
+	mArrayBufferKnown = false;
+	mArrayBuffer = 0;
+	mElementBufferKnown = false;
+	mElementBuffer = 0;
+	mMatrixModeKnown = false;
+	mMatrixMode = 0;
+	mClearColorKnown = false;
+	mClearDepthKnown = false;
+	mClearDepth = 0.0f;
+}
+
+/**
+ * Count the call and tell whether it must be passed on.
+ */
+bool GLStateCache::changed(bool isChanged)
+{
+	if(isChanged)
+	{
+		mIssuedCalls++;
+	}
+	else
+	{
+		mEliminatedCalls++;
+	}
+	return isChanged;
+}
+
+int GLStateCache::findFlag(const flagState *flags, int numFlags, GLenum name)
+{
+	for(int i = 0; i < numFlags; i++)
+	{
+		if(flags[i].name == name)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+/**
+ * Record the new value of the flag, returning true if the
+ * GL has to be told about it.
+ */
+bool GLStateCache::setFlag(flagState *flags, int &numFlags, int maxFlags, GLenum name, bool enabled)
+{
+	int i = findFlag(flags, numFlags, name);
+	if(i < 0)
+	{
+		// Not set through us yet, or no room to remember it.
+		if(numFlags < maxFlags)
+		{
+			flags[numFlags].name = name;
+			flags[numFlags].enabled = enabled;
+			numFlags++;
+		}
+		return changed(true);
+	}
+	bool isChanged = flags[i].enabled != enabled;
+	flags[i].enabled = enabled;
+	return changed(isChanged);
+}
+
+void GLStateCache::bindTexture(GLuint texture)
+{
+	if(changed(!mTextureKnown || mTexture != texture))
+	{
+		glBindTexture(GL_TEXTURE_2D, texture);
+		mTexture = texture;
+		mTextureKnown = true;
+		mCounters.textureBinds++;
+	}
+}
+
+void GLStateCache::deleteTexture(GLuint texture)
+{
+	glDeleteTextures(1, &texture);
+	if(mTextureKnown && mTexture == texture)
+	{
+		mTexture = 0;
+	}
+}
+
+void GLStateCache::bindBuffer(GLenum target, GLuint buffer)
+{
+	bool &known = (target == GL_ARRAY_BUFFER) ? mArrayBufferKnown : mElementBufferKnown;
+	GLuint &bound = (target == GL_ARRAY_BUFFER) ? mArrayBuffer : mElementBuffer;
+	if(changed(!known || bound != buffer))
+	{
+		glBindBuffer(target, buffer);
+		bound = buffer;
+		known = true;
+	}
+}
+
+void GLStateCache::enable(GLenum cap)
+{
+	if(setFlag(mCaps, mNumCaps, GL_STATE_MAX_CAPS, cap, true))
+	{
+		glEnable(cap);
+	}
+}
+
+void GLStateCache::disable(GLenum cap)
+{
+	if(setFlag(mCaps, mNumCaps, GL_STATE_MAX_CAPS, cap, false))
+	{
+		glDisable(cap);
+	}
+}
+
+void GLStateCache::enableClientState(GLenum array)
+{
+	if(setFlag(mArrays, mNumArrays, GL_STATE_MAX_ARRAYS, array, true))
+	{
+		glEnableClientState(array);
+	}
+}
+
+void GLStateCache::disableClientState(GLenum array)
+{
+	if(setFlag(mArrays, mNumArrays, GL_STATE_MAX_ARRAYS, array, false))
+	{
+		glDisableClientState(array);
+	}
+}
+
+void GLStateCache::matrixMode(GLenum mode)
+{
+	if(changed(!mMatrixModeKnown || mMatrixMode != mode))
+	{
+		glMatrixMode(mode);
+		mMatrixMode = mode;
+		mMatrixModeKnown = true;
+	}
+}
+
+void GLStateCache::clearColor(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha)
+{
+	if(changed(!mClearColorKnown ||
+		mClearColor[0] != red || mClearColor[1] != green ||
+		mClearColor[2] != blue || mClearColor[3] != alpha))
+	{
+		glClearColor(red, green, blue, alpha);
+		mClearColor[0] = red;
+		mClearColor[1] = green;
+		mClearColor[2] = blue;
+		mClearColor[3] = alpha;
+		mClearColorKnown = true;
+	}
+}
+
+void GLStateCache::clearDepth(GLclampf depth)
+{
+	if(changed(!mClearDepthKnown || mClearDepth != depth))
+	{
+		glClearDepthf(depth);
+		mClearDepth = depth;
+		mClearDepthKnown = true;
+	}
+}
+
+void GLStateCache::drawArrays(GLenum mode, GLint first, GLsizei count)
+{
+	glDrawArrays(mode, first, count);
+	mCounters.drawCalls++;
+	mCounters.vertices += count;
+}
+
+void GLStateCache::drawElements(GLenum mode, GLsizei count, GLenum type,
+	const GLvoid *indices, int vertices)
+{
+	glDrawElements(mode, count, type, indices);
+	mCounters.drawCalls++;
+	mCounters.vertices += vertices;
+	mCounters.indices += count;
+}
+
+void GLStateCache::resetCounters()
+{
+	mCounters.drawCalls = 0;
+	mCounters.vertices = 0;
+	mCounters.indices = 0;
+	mCounters.textureBinds = 0;
+}
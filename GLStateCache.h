@@ -0,0 +1,138 @@
+/*
+ * GLStateCache.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef GLSTATECACHE_H_
+#define GLSTATECACHE_H_
+
+#include <GLES/gl.h>
+
+// How many server side caps and client arrays are tracked.
+#define GL_STATE_MAX_CAPS 16
+#define GL_STATE_MAX_ARRAYS 4
+
+// Work passed on to the GL since the counters were last reset.
+struct glSubmitCounters{
+	int drawCalls;
+	int vertices;
+	int indices;
+	int textureBinds;
+};
+
+/**
+ * Shadows the GL state the renderer changes every frame and
+ * only passes calls on to the GL when they change something.
+ *
+ * All changes to the tracked state must go through the cache,
+ * otherwise it gets out of sync with the GL. State that has
+ * not been set through the cache yet is unknown, and the first
+ * call setting it is always passed on.
+ */
+class GLStateCache
+{
+public:
+	GLStateCache();
+
+	/**
+	 * Forget everything, e.g. for a new GL context.
+	 */
+	void invalidate();
+
+	void bindTexture(GLuint texture);
+
+	/**
+	 * Delete a texture, which unbinds it if it is bound.
+	 */
+	void deleteTexture(GLuint texture);
+
+	/**
+	 * The texture binding was changed behind the cache's back,
+	 * e.g. by TextureLoader.
+	 */
+	void forgetTexture() { mTextureKnown = false; }
+
+	void bindBuffer(GLenum target, GLuint buffer);
+
+	void enable(GLenum cap);
+
+	void disable(GLenum cap);
+
+	void enableClientState(GLenum array);
+
+	void disableClientState(GLenum array);
+
+	void matrixMode(GLenum mode);
+
+	void clearColor(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha);
+
+	void clearDepth(GLclampf depth);
+
+	/**
+	 * glDrawArrays, counted.
+	 */
+	void drawArrays(GLenum mode, GLint first, GLsizei count);
+
+	/**
+	 * glDrawElements, counted. vertices is the number of distinct
+	 * vertices the indices refer to, which the GL is not told.
+	 */
+	void drawElements(GLenum mode, GLsizei count, GLenum type,
+		const GLvoid *indices, int vertices);
+
+	const glSubmitCounters& getCounters() const { return mCounters; }
+
+	void resetCounters();
+
+	/**
+	 * Calls dropped because they would not have changed anything.
+	 */
+	int getEliminatedCalls() const { return mEliminatedCalls; }
+
+	/**
+	 * Calls passed on to the GL.
+	 */
+	int getIssuedCalls() const { return mIssuedCalls; }
+
+private:
+	struct flagState{
+		GLenum name;
+		bool enabled;
+	};
+
+	/**
+	 * Index of the flag in the table, -1 if it is not there.
+	 */
+	static int findFlag(const flagState *flags, int numFlags, GLenum name);
+
+	bool setFlag(flagState *flags, int &numFlags, int maxFlags, GLenum name, bool enabled);
+
+	bool changed(bool isChanged);
+
+	flagState mCaps[GL_STATE_MAX_CAPS];
+	int mNumCaps;
+	flagState mArrays[GL_STATE_MAX_ARRAYS];
+	int mNumArrays;
+
+	// Entries of mCaps and mArrays are known once they are in the
+	// table, the rest use these flags.
+	bool mTextureKnown;
+	GLuint mTexture;
+	bool mArrayBufferKnown;
+	GLuint mArrayBuffer;
+	bool mElementBufferKnown;
+	GLuint mElementBuffer;
+	bool mMatrixModeKnown;
+	GLenum mMatrixMode;
+	bool mClearColorKnown;
+	GLclampf mClearColor[4];
+	bool mClearDepthKnown;
+	GLclampf mClearDepth;
+
+	int mEliminatedCalls;
+	int mIssuedCalls;
+	glSubmitCounters mCounters;
+};
+
+#endif /* GLSTATECACHE_H_ */
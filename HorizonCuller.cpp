@@ -0,0 +1,239 @@
+/*
+ * HorizonCuller.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include <mastdlib.h>
+#include <madmath.h>
+#include "HorizonCuller.h"
+#include "MemoryTracker.h"
+
+// Below anything the terrain can have.
+#define NO_HORIZON -1e30f
+
+// A full turn in diamond angle units.
+#define TURN 4.0f
+
+HorizonCuller::HorizonCuller():
+	mRange(0.0f),
+	mPending(NULL),
+	mNumPending(0),
+	mMaxPending(0)
+{
+	float eye[3] = {0.0f, 0.0f, 0.0f};
+	begin(eye, 0.0f);
+}
+
+HorizonCuller::~HorizonCuller()
+{
+	delete[] mPending;
+}
+
+void HorizonCuller::begin(const float *eye, float range)
+{
+	for(int i = 0; i < 3; i++)
+	{
+		mEye[i] = eye[i];
+	}
+	mRange = range;
+	for(int i = 0; i < HORIZON_SECTORS; i++)
+	{
+		mHorizon[i] = NO_HORIZON;
+	}
+	mNumPending = 0;
+}
+
+float HorizonCuller::getDistance(const float *min, const float *max) const
+{
+	float distance = 0.0f;
+	for(int j = 0; j < 2; j++)
+	{
+		float d = (mEye[j] < min[j]) ? min[j] - mEye[j] :
+			(mEye[j] > max[j]) ? mEye[j] - max[j] : 0.0f;
+		distance += d * d;
+	}
+	return sqrt(distance);
+}
+
+float HorizonCuller::getFarDistance(const float *min, const float *max) const
+{
+	float distance = 0.0f;
+	for(int j = 0; j < 2; j++)
+	{
+		float d0 = mEye[j] - min[j];
+		float d1 = max[j] - mEye[j];
+		float d = (d0 > d1) ? d0 : d1;
+		distance += d * d;
+	}
+	return sqrt(distance);
+}
+
+/**
+ * Direction of (dx, dy) from 0 to 4, counter-clockwise from
+ * the x axis with a unit per quarter turn.
+ */
+float HorizonCuller::direction(float dx, float dy)
+{
+	if(dy >= 0)
+	{
+		return (dx >= 0) ? dy / (dx + dy) : 1 - dx / (dy - dx);
+	}
+	return (dx < 0) ? 2 - dy / (-dx - dy) : 3 + dx / (dx - dy);
+}
+
+/**
+ * The directions the box spans, in sectors. The last may be
+ * past HORIZON_SECTORS.
+ * @return false if the eye is above the box.
+ */
+bool HorizonCuller::getSectors(const float *min, const float *max,
+	float &first, float &last) const
+{
+	if(mEye[0] >= min[0] && mEye[0] <= max[0] &&
+		mEye[1] >= min[1] && mEye[1] <= max[1])
+	{
+		return false;
+	}
+
+	float corners[4];
+	for(int i = 0; i < 4; i++)
+	{
+		float x = (i & 1) ? max[0] : min[0];
+		float y = (i & 2) ? max[1] : min[1];
+		corners[i] = direction(x - mEye[0], y - mEye[1]);
+	}
+
+	// Seen from outside, the box spans less than half a turn,
+	// two diamond units. It starts at the corner all the
+	// others are less than that ahead of.
+	for(int i = 0; i < 4; i++)
+	{
+		float span = 0.0f;
+		bool start = true;
+		for(int j = 0; j < 4 && start; j++)
+		{
+			float d = corners[j] - corners[i];
+			d = (d < 0) ? d + TURN : d;
+			start = d < TURN / 2;
+			span = (d > span) ? d : span;
+		}
+		if(start)
+		{
+			first = corners[i] * (HORIZON_SECTORS / TURN);
+			last = (corners[i] + span) * (HORIZON_SECTORS / TURN);
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Add the occluders whose far side is nearer than distance.
+ */
+void HorizonCuller::merge(float distance)
+{
+	while(mNumPending > 0 && mPending[0].distance <= distance)
+	{
+		horizonOccluder *occluder = &mPending[0];
+		for(int s = occluder->firstSector; s <= occluder->lastSector; s++)
+		{
+			float *horizon = &mHorizon[s & (HORIZON_SECTORS - 1)];
+			*horizon = (occluder->elevation > *horizon) ? occluder->elevation : *horizon;
+		}
+
+		// Pop the nearest off the heap.
+		horizonOccluder last = mPending[--mNumPending];
+		int i = 0;
+		while(true)
+		{
+			int child = i * 2 + 1;
+			if(child >= mNumPending)
+			{
+				break;
+			}
+			if(child + 1 < mNumPending && mPending[child + 1].distance < mPending[child].distance)
+			{
+				child++;
+			}
+			if(last.distance <= mPending[child].distance)
+			{
+				break;
+			}
+			mPending[i] = mPending[child];
+			i = child;
+		}
+		mPending[i] = last;
+	}
+}
+
+bool HorizonCuller::isBoxOccluded(const float *min, const float *max)
+{
+	float nearDistance = getDistance(min, max);
+	float first, last;
+	if(nearDistance > mRange || !getSectors(min, max, first, last))
+	{
+		return false;
+	}
+	merge(nearDistance);
+
+	// The highest the top of the box can appear.
+	float height = max[2] - mEye[2];
+	float elevation = height / ((height > 0) ? nearDistance : getFarDistance(min, max));
+	for(int s = (int)first; s <= (int)last; s++)
+	{
+		if(elevation >= mHorizon[s & (HORIZON_SECTORS - 1)])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void HorizonCuller::addOccluder(const float *min, const float *max)
+{
+	float nearDistance = getDistance(min, max);
+	float first, last;
+	if(nearDistance > mRange || !getSectors(min, max, first, last))
+	{
+		return;
+	}
+	// Only sectors the box covers completely are blocked in
+	// every direction within them.
+	int firstSector = (int)ceil(first);
+	int lastSector = (int)floor(last) - 1;
+	if(lastSector < firstSector)
+	{
+		return;
+	}
+
+	if(mNumPending == mMaxPending)
+	{
+		MemoryTagScope scope(MEMTAG_TERRAIN);
+		int size = (mMaxPending > 0) ? mMaxPending * 2 : 256;
+		horizonOccluder *pending = new horizonOccluder[size];
+		memcpy(pending, mPending, mNumPending * sizeof(horizonOccluder));
+		delete[] mPending;
+		mPending = pending;
+		mMaxPending = size;
+	}
+
+	// Every direction in the sectors crosses the box, where
+	// the surface is at least its minimum height.
+	float farDistance = getFarDistance(min, max);
+	float height = min[2] - mEye[2];
+	horizonOccluder occluder;
+	occluder.firstSector = firstSector;
+	occluder.lastSector = lastSector;
+	occluder.elevation = height / ((height > 0) ? farDistance : nearDistance);
+	occluder.distance = farDistance;
+
+	// Push onto the heap.
+	int i = mNumPending++;
+	while(i > 0 && mPending[(i - 1) / 2].distance > occluder.distance)
+	{
+		mPending[i] = mPending[(i - 1) / 2];
+		i = (i - 1) / 2;
+	}
+	mPending[i] = occluder;
+}
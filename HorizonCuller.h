@@ -0,0 +1,94 @@
+/*
+ * HorizonCuller.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef HORIZONCULLER_H_
+#define HORIZONCULLER_H_
+
+// Directions around the eye the horizon is tracked in,
+// a power of two.
+#define HORIZON_SECTORS 256
+
+// Part of the terrain seen from the eye.
+struct horizonOccluder{
+	// Sectors the box covers completely, first to last. The
+	// last may be past HORIZON_SECTORS, they wrap around.
+	int firstSector;
+	int lastSector;
+	// Lowest elevation the box's surface can have in them.
+	float elevation;
+	// Distance of the far side of the box.
+	float distance;
+};
+
+/**
+ * Occlusion culling for a height field, against the horizon
+ * formed by the terrain nearer to the eye.
+ *
+ * The horizon is the highest elevation, height over distance
+ * from the eye, of the terrain seen so far in each direction
+ * around the eye. Boxes of terrain are passed front to back:
+ * a box is hidden when its top stays below the horizon in all
+ * the directions it spans. Since the terrain is solid below its
+ * surface this holds for any camera orientation.
+ *
+ * Directions are diamond angles, which grow with the true angle
+ * but need no trigonometry.
+ */
+class HorizonCuller
+{
+public:
+	HorizonCuller();
+
+	~HorizonCuller();
+
+	/**
+	 * Start a new sweep from the eye, with an empty horizon.
+	 * Boxes further than range are neither tested nor added.
+	 */
+	void begin(const float *eye, float range);
+
+	/**
+	 * Horizontal distance from the eye to the nearest point of
+	 * the box, the order boxes must be passed in.
+	 */
+	float getDistance(const float *min, const float *max) const;
+
+	const float *getEye() const { return mEye; }
+
+	float getRange() const { return mRange; }
+
+	/**
+	 * @return true if the box is entirely below the horizon of
+	 * the occluders added so far that are nearer than it.
+	 */
+	bool isBoxOccluded(const float *min, const float *max);
+
+	/**
+	 * Add a box of terrain, whose surface is nowhere lower than
+	 * min[2], to the horizon.
+	 */
+	void addOccluder(const float *min, const float *max);
+
+private:
+	static float direction(float dx, float dy);
+
+	bool getSectors(const float *min, const float *max, float &first, float &last) const;
+
+	float getFarDistance(const float *min, const float *max) const;
+
+	void merge(float distance);
+
+	float mEye[3];
+	float mRange;
+	float mHorizon[HORIZON_SECTORS];
+	// Occluders not yet in the horizon, as they may not be in
+	// front of the next boxes. A heap on distance.
+	horizonOccluder *mPending;
+	int mNumPending;
+	int mMaxPending;
+};
+
+#endif /* HORIZONCULLER_H_ */
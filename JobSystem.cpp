@@ -0,0 +1,212 @@
+/*
+ * JobSystem.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "JobSystem.h"
+
+Job::Job():
+	mState(JOB_IDLE),
+	mPendingDependencies(0),
+	mListener(NULL),
+	mNext(NULL)
+{
+}
+
+Job::~Job()
+{
+}
+
+bool Job::step(int budget)
+{
+	run();
+	return true;
+}
+
+void Job::dependsOn(Job *job)
+{
+	if(job->isDone())
+	{
+		return;
+	}
+	job->mSuccessors.add(this);
+	mPendingDependencies++;
+}
+
+ParallelForJob::ParallelForJob(int begin, int end, int grain):
+	mCurrent(begin),
+	mEnd(end),
+	mGrain(grain > 0 ? grain : 1),
+	mAdaptive(grain <= 0)
+{
+}
+
+void ParallelForJob::run()
+{
+	if(mCurrent < mEnd)
+	{
+		runRange(mCurrent, mEnd);
+		mCurrent = mEnd;
+	}
+}
+
+bool ParallelForJob::step(int budget)
+{
+	int start = maGetMilliSecondCount();
+	while(mCurrent < mEnd)
+	{
+		int end = mCurrent + mGrain;
+		if(end > mEnd)
+		{
+			end = mEnd;
+		}
+		int sliceStart = maGetMilliSecondCount();
+		runRange(mCurrent, end);
+		mCurrent = end;
+		int now = maGetMilliSecondCount();
+
+		if(mAdaptive)
+		{
+			// Grow the slices while they are too cheap to measure
+			// and shrink them when one would not fit the budget.
+			int sliceTime = now - sliceStart;
+			if(sliceTime == 0)
+			{
+				mGrain *= 2;
+			}
+			else if(sliceTime > budget / 2 && mGrain > 1)
+			{
+				mGrain /= 2;
+			}
+		}
+
+		if(now - start >= budget)
+		{
+			break;
+		}
+	}
+	return mCurrent >= mEnd;
+}
+
+JobSystem& JobSystem::getJobSystem()
+{
+	static JobSystem jobSystem;
+	return jobSystem;
+}
+
+JobSystem::JobSystem():
+	mHead(NULL),
+	mTail(NULL),
+	mPending(0),
+	mTimeSlice(JOB_DEFAULT_TIME_SLICE),
+	mListening(false)
+{
+}
+
+void JobSystem::submit(Job *job, JobListener *listener)
+{
+	job->mListener = listener;
+	job->mState = Job::JOB_SUBMITTED;
+	mPending++;
+	if(job->mPendingDependencies == 0)
+	{
+		enqueue(job);
+	}
+}
+
+void JobSystem::enqueue(Job *job)
+{
+	job->mState = Job::JOB_QUEUED;
+	job->mNext = NULL;
+	if(mTail != NULL)
+	{
+		mTail->mNext = job;
+	}
+	else
+	{
+		mHead = job;
+	}
+	mTail = job;
+
+	if(!mListening)
+	{
+		Environment::getEnvironment().addIdleListener(this);
+		mListening = true;
+	}
+}
+
+void JobSystem::wait(Job *job)
+{
+	while(!job->isDone())
+	{
+		if(mHead == NULL)
+		{
+			maPanic(0, "JobSystem: waiting on a job that can never run");
+		}
+		process(mTimeSlice);
+	}
+}
+
+void JobSystem::setTimeSlice(int ms)
+{
+	mTimeSlice = ms > 0 ? ms : 1;
+}
+
+void JobSystem::idle()
+{
+	process(mTimeSlice);
+	if(mHead == NULL && mListening)
+	{
+		// Don't keep the event loop spinning when there is nothing to do.
+		Environment::getEnvironment().removeIdleListener(this);
+		mListening = false;
+	}
+}
+
+void JobSystem::process(int budget)
+{
+	int start = maGetMilliSecondCount();
+	while(mHead != NULL)
+	{
+		Job *job = mHead;
+		int remaining = budget - (maGetMilliSecondCount() - start);
+		if(job->step(remaining > 0 ? remaining : 1))
+		{
+			mHead = job->mNext;
+			if(mHead == NULL)
+			{
+				mTail = NULL;
+			}
+			complete(job);
+		}
+		if(maGetMilliSecondCount() - start >= budget)
+		{
+			break;
+		}
+	}
+}
+
+void JobSystem::complete(Job *job)
+{
+	job->mState = Job::JOB_DONE;
+	job->mNext = NULL;
+	mPending--;
+
+	for(int i = 0; i < job->mSuccessors.size(); i++)
+	{
+		Job *successor = job->mSuccessors[i];
+		successor->mPendingDependencies--;
+		if(successor->mPendingDependencies == 0 &&
+			successor->mState == Job::JOB_SUBMITTED)
+		{
+			enqueue(successor);
+		}
+	}
+	job->mSuccessors.clear();
+
+	if(job->mListener != NULL)
+	{
+		job->mListener->jobCompleted(job);
+	}
+}
@@ -0,0 +1,151 @@
+/*
+ * JobSystem.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef JOBSYSTEM_H_
+#define JOBSYSTEM_H_
+
+#include <ma.h>
+#include <MAUtil/Environment.h>
+#include <MAUtil/Vector.h>
+
+using namespace MAUtil;
+
+// Milliseconds of job work done per idle event by default.
+#define JOB_DEFAULT_TIME_SLICE 4
+
+class Job;
+
+/**
+ * Notified on the event thread when a job has finished.
+ */
+class JobListener
+{
+public:
+	virtual void jobCompleted(Job *job) = 0;
+};
+
+/**
+ * A unit of work. Jobs are owned by whoever creates them and
+ * must outlive their execution.
+ */
+class Job
+{
+public:
+	Job();
+
+	virtual ~Job();
+
+	/**
+	 * The work itself.
+	 */
+	virtual void run() = 0;
+
+	/**
+	 * Do some of the work, spending roughly at most budget
+	 * milliseconds. The default runs the whole job at once.
+	 * @return true when the job is finished.
+	 */
+	virtual bool step(int budget);
+
+	/**
+	 * Make this job wait until job has completed.
+	 * Must be called before this job is submitted.
+	 */
+	void dependsOn(Job *job);
+
+	bool isDone() const { return mState == JOB_DONE; }
+
+private:
+	friend class JobSystem;
+
+	enum JobState
+	{
+		JOB_IDLE,
+		JOB_SUBMITTED,
+		JOB_QUEUED,
+		JOB_DONE
+	};
+
+	JobState mState;
+	int mPendingDependencies;
+	Vector<Job*> mSuccessors;
+	JobListener *mListener;
+	Job *mNext;
+};
+
+/**
+ * A job that calls runRange() over slices of [begin, end).
+ * When no grain size is given it is adapted at run time so
+ * that a slice fits in the scheduler's time slice.
+ */
+class ParallelForJob : public Job
+{
+public:
+	ParallelForJob(int begin, int end, int grain = 0);
+
+	virtual void runRange(int begin, int end) = 0;
+
+	void run();
+
+	bool step(int budget);
+
+private:
+	int mCurrent;
+	int mEnd;
+	int mGrain;
+	bool mAdaptive;
+};
+
+/**
+ * Schedules jobs and task graphs on the event thread.
+ *
+ * MoSync does not give applications threads of their own, so
+ * jobs are run from the Environment's idle event in time slices,
+ * which keeps input, timers and rendering responsive while
+ * long running work such as terrain generation makes progress.
+ * Completion listeners are called from the same event.
+ */
+class JobSystem : public IdleListener
+{
+public:
+	static JobSystem& getJobSystem();
+
+	/**
+	 * Queue a job. It runs once all its dependencies are done.
+	 */
+	void submit(Job *job, JobListener *listener = NULL);
+
+	/**
+	 * Run jobs on the calling thread until job is done.
+	 */
+	void wait(Job *job);
+
+	/**
+	 * Set how many milliseconds of jobs are run per idle event.
+	 */
+	void setTimeSlice(int ms);
+
+	int getPendingJobs() const { return mPending; }
+
+	void idle();
+
+private:
+	JobSystem();
+
+	void enqueue(Job *job);
+
+	void process(int budget);
+
+	void complete(Job *job);
+
+	Job *mHead;
+	Job *mTail;
+	int mPending;
+	int mTimeSlice;
+	bool mListening;
+};
+
+#endif /* JOBSYSTEM_H_ */
@@ -7,11 +7,50 @@
 
 #include "LuaFunctions.h"
 #include "maapi.h"
+#include "RenderStats.h"
+
+static const RenderStats *sRenderStats = NULL;
 
 int TestFunc(lua_State *L)
 {
 	maPanic(0,"sfsdfds");
 }
 
+void SetLuaRenderStats(const RenderStats *stats)
+{
+	sRenderStats = stats;
+}
+
+static void setField(lua_State *L, const char *name, lua_Number value)
+{
+	lua_pushnumber(L, value);
+	lua_setfield(L, -2, name);
+}
 
+int GetRenderStats(lua_State *L)
+{
+	if(sRenderStats == NULL)
+	{
+		lua_pushnil(L);
+		return 1;
+	}
 
+	const renderFrameStats &last = sRenderStats->getLast();
+	lua_createtable(L, 0, 16);
+	setField(L, "drawCalls", last.drawCalls);
+	setField(L, "vertices", last.vertices);
+	setField(L, "indices", last.indices);
+	setField(L, "textureBinds", last.textureBinds);
+	setField(L, "drawnChunks", last.drawnChunks);
+	setField(L, "culledChunks", last.culledChunks);
+	setField(L, "occludedChunks", last.occludedChunks);
+	setField(L, "submitTime", last.submitTime);
+	setField(L, "waitTime", last.waitTime);
+	setField(L, "frameTime", last.frameTime);
+	setField(L, "fps", sRenderStats->getFPS());
+	setField(L, "frameTime50", sRenderStats->getFrameTimePercentile(50));
+	setField(L, "frameTime90", sRenderStats->getFrameTimePercentile(90));
+	setField(L, "frameTime99", sRenderStats->getFrameTimePercentile(99));
+	setField(L, "frames", sRenderStats->getNumFrames());
+	return 1;
+}
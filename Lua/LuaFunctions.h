@@ -9,7 +9,21 @@
 #define LUAFUNCTIONS_H_
 #include "lua.h"
 
+class RenderStats;
+
 int TestFunc(lua_State *L);
 
+/**
+ * The statistics engine.GetRenderStats reports.
+ */
+void SetLuaRenderStats(const RenderStats *stats);
+
+/**
+ * engine.GetRenderStats() returns a table with the cost of the
+ * last frame, the FPS and the 50th, 90th and 99th percentile
+ * frame times, or nil when there are no statistics.
+ */
+int GetRenderStats(lua_State *L);
+
 
 #endif /* LUAFUNCTIONS_H_ */
@@ -31,6 +31,8 @@
 #include "LuaErrorListener.h"
 #include "LuaFunctions.h"
 
+class LuaAllocator;
+
 namespace MobileLua
 {
 
@@ -91,6 +93,39 @@ public:
 	 */
 	virtual int eval(const char* script);
 
+	/**
+	 * Run the garbage collector for about the given number of
+	 * microseconds, e.g. with the time left at the end of a frame.
+	 * Does nothing between collection cycles until the heap has
+	 * grown as far as the collector would let it. The budget is
+	 * rounded down to whole milliseconds. In generational mode a
+	 * minor collection can't be split, so it runs whole if the
+	 * last one took no longer than the budget.
+	 * @param budgetMicroseconds Time the collector may take.
+	 * @return Non-zero if a collection cycle finished.
+	 */
+	virtual int collectGarbage(int budgetMicroseconds);
+
+	/**
+	 * Let the collector also run while scripts allocate, on by
+	 * default. Off, it only runs in collectGarbage(), unless it
+	 * falls too far behind.
+	 */
+	virtual void setAllocationGC(bool enabled);
+
+	/**
+	 * Give the next Lua state a LuaAllocator, which keeps small
+	 * blocks in size class slabs, instead of allocating every
+	 * block from the heap. Off by default. Takes effect when
+	 * initialize() is called.
+	 */
+	virtual void setPooledAllocator(bool enabled);
+
+	/**
+	 * The pooled allocator of the current state, or NULL.
+	 */
+	LuaAllocator* getAllocator() { return mAllocator; }
+
 	/**
 	 * Set a listener that will get notified when there is a
 	 * Lua error.
@@ -119,6 +154,27 @@ public:
 	 * Listener called when a Lua error occurs.
 	 */
 	LuaErrorListener* mLuaErrorListener;
+
+	/**
+	 * True if allocations may run the collector.
+	 */
+	bool mAllocationGC;
+
+	/**
+	 * Heap size in KB after the last collection collectGarbage()
+	 * finished, true while it is stepping through a cycle, and
+	 * how long its last minor collection took.
+	 */
+	int mGCBaseKB;
+	bool mGCCycleRunning;
+	int mGCMinorMilliseconds;
+
+	/**
+	 * True if initialize() creates a pooled allocator, and the
+	 * one the current state uses.
+	 */
+	bool mPooledAllocator;
+	LuaAllocator* mAllocator;
 };
 
 }
@@ -29,7 +29,7 @@
 #define GCFINALIZECOST	100
 
 
-#define maskmarks	cast_byte(~(bitmask(BLACKBIT)|WHITEBITS))
+#define maskmarks	cast_byte(~(bitmask(BLACKBIT)|WHITEBITS|bitmask(OLDBIT)))
 
 #define makewhite(g,x)	\
    ((x)->gch.marked = cast_byte(((x)->gch.marked & maskmarks) | luaC_white(g)))
@@ -58,6 +58,12 @@
 
 #define setthreshold(g)  (g->GCthreshold = (g->estimate/100) * g->gcpause)
 
+/* next minor collection once the young generation has grown */
+#define setminorthreshold(g)  \
+  (g->GCthreshold = g->totalbytes + \
+     (g->estimate > GCSTEPSIZE*100/LUAI_GCMINOR ? \
+      (g->estimate/100) * LUAI_GCMINOR : GCSTEPSIZE))
+
 
 static void removeentry (Node *n) {
   lua_assert(ttisnil(gval(n)));
@@ -428,6 +434,35 @@ static GCObject **sweeplist (lua_State *L, GCObject **p, lu_mem count) {
 }
 
 
+/*
+** Sweep in generational mode: free the dead, and make the survivors
+** old with their marks kept, so the next minor collection does not
+** trace them again. New objects are linked at the head of a list, so
+** unless `all' the sweep stops at the first old object.
+*/
+static void sweepgen (lua_State *L, GCObject **p, int all) {
+  GCObject *curr;
+  global_State *g = G(L);
+  int deadmask = otherwhite(g);
+  while ((curr = *p) != NULL) {
+    if (!all && isold(curr))
+      return;  /* the rest of the list is older */
+    if (curr->gch.tt == LUA_TTHREAD)  /* open upvalues are kept by level */
+      sweepgen(L, &gco2th(curr)->openupval, 1);
+    if ((curr->gch.marked ^ WHITEBITS) & deadmask) {  /* not dead? */
+      l_setbit(curr->gch.marked, OLDBIT);
+      p = &curr->gch.next;
+    }
+    else {  /* must erase `curr' */
+      *p = curr->gch.next;
+      if (curr == g->rootgc)  /* is the first element of the list? */
+        g->rootgc = curr->gch.next;  /* adjust first */
+      freeobj(L, curr);
+    }
+  }
+}
+
+
 static void checkSizes (lua_State *L) {
   global_State *g = G(L);
   /* check size of string hash */
@@ -572,7 +607,15 @@ static l_mem singlestep (lua_State *L) {
     }
     case GCSsweepstring: {
       lu_mem old = g->totalbytes;
-      sweepwholelist(L, &g->strt.hash[g->sweepstrgc++]);
+      if (isgenerational(g)) {  /* all at once, most lists start old */
+        for (; g->sweepstrgc < g->strt.size; g->sweepstrgc++) {
+          GCObject *o = g->strt.hash[g->sweepstrgc];
+          if (o != NULL && !isold(o))
+            sweepgen(L, &g->strt.hash[g->sweepstrgc], 0);
+        }
+      }
+      else
+        sweepwholelist(L, &g->strt.hash[g->sweepstrgc++]);
       if (g->sweepstrgc >= g->strt.size)  /* nothing more to sweep? */
         g->gcstate = GCSsweep;  /* end sweep-string phase */
       lua_assert(old >= g->totalbytes);
@@ -581,8 +624,18 @@ static l_mem singlestep (lua_State *L) {
     }
     case GCSsweep: {
       lu_mem old = g->totalbytes;
-      g->sweepgc = sweeplist(L, g->sweepgc, GCSWEEPMAX);
-      if (*g->sweepgc == NULL) {  /* nothing more to sweep? */
+      int done;
+      if (isgenerational(g)) {
+        /* userdata are linked after the main thread, young ones first */
+        sweepgen(L, &g->rootgc, 0);
+        sweepgen(L, &g->mainthread->next, 0);
+        done = 1;
+      }
+      else {
+        g->sweepgc = sweeplist(L, g->sweepgc, GCSWEEPMAX);
+        done = (*g->sweepgc == NULL);
+      }
+      if (done) {  /* nothing more to sweep? */
         checkSizes(L);
         g->gcstate = GCSfinalize;  /* end sweep phase */
       }
@@ -608,9 +661,101 @@ static l_mem singlestep (lua_State *L) {
 }
 
 
+/*
+** Return every object to white and forget the gray lists, leaving
+** nothing old. Nothing is collected, as white has not changed.
+*/
+static void whitenall (lua_State *L) {
+  global_State *g = G(L);
+  int i;
+  lua_assert(g->gcstate == GCSpause || g->gcstate == GCSpropagate);
+  for (i = 0; i < g->strt.size; i++)
+    sweepwholelist(L, &g->strt.hash[i]);
+  sweepwholelist(L, &g->rootgc);
+  g->gray = NULL;
+  g->grayagain = NULL;
+  g->weak = NULL;
+}
+
+
+/*
+** In generational mode the collector stays in the propagate state
+** between collections: barriers mark young objects as they are stored
+** in old ones, and the gray lists keep the threads and weak tables,
+** which are traversed again by every collection. A minor collection
+** runs the rest of the cycle at once.
+*/
+static void minorcollection (lua_State *L) {
+  global_State *g = G(L);
+  lua_assert(g->gcstate == GCSpropagate);
+  while (g->gcstate != GCSpause)
+    singlestep(L);
+  g->gcstate = GCSpropagate;  /* skip the restart, old objects stay marked */
+}
+
+
+/*
+** A full collection, after which everything alive is old.
+*/
+static void majorcollection (lua_State *L) {
+  global_State *g = G(L);
+  whitenall(L);
+  markroot(L);
+  minorcollection(L);  /* nothing is old, so the sweep covers everything */
+  g->gcmajor = 0;
+  g->gcmajorbase = g->estimate;
+}
+
+
+static void generationalcollection (lua_State *L) {
+  global_State *g = G(L);
+  if (g->gcmajor)
+    majorcollection(L);
+  else
+    minorcollection(L);
+  /* old objects are only collected by major collections, so run one
+     once the memory in use has grown enough since the last */
+  if (g->estimate > (g->gcmajorbase/100) * g->gcpause)
+    g->gcmajor = 1;
+  setminorthreshold(g);
+}
+
+
+void luaC_changemode (lua_State *L, int mode) {
+  global_State *g = G(L);
+  if (mode == g->gckind)
+    return;
+  if (isgenerational(g) && g->gcstate != GCSpropagate)
+    return;  /* inside a collection, e.g. in a finalizer */
+  if (mode == KGC_GEN) {
+    /* finish the current cycle, then start from a major collection */
+    while (g->gcstate != GCSpause)
+      singlestep(L);
+    g->gckind = KGC_GEN;
+    majorcollection(L);
+    setminorthreshold(g);
+  }
+  else {
+    /* back to the incremental invariants: no black objects */
+    whitenall(L);
+    g->gckind = KGC_INC;
+    g->gcstate = GCSpause;
+    g->gcdept = 0;
+    setthreshold(g);
+  }
+}
+
+
 void luaC_step (lua_State *L) {
   global_State *g = G(L);
   l_mem lim = (GCSTEPSIZE/100) * g->gcstepmul;
+  if (isgenerational(g)) {
+    if (g->gcstate == GCSpropagate)  /* not inside a collection? */
+      generationalcollection(L);
+    else if (g->gcstate != GCSpause)
+      singlestep(L);  /* e.g. from a finalizer, just move it along */
+    return;
+  }
   if (lim == 0)
     lim = (MAX_LUMEM-1)/2;  /* no limit */
   g->gcdept += g->totalbytes - g->GCthreshold;
@@ -636,6 +781,13 @@ void luaC_step (lua_State *L) {
 
 void luaC_fullgc (lua_State *L) {
   global_State *g = G(L);
+  if (isgenerational(g)) {
+    if (g->gcstate == GCSpropagate) {  /* not inside a collection? */
+      g->gcmajor = 1;
+      generationalcollection(L);
+    }
+    return;
+  }
   if (g->gcstate <= GCSpropagate) {
     /* reset sweep marks to sweep all elements (returning them to white) */
     g->sweepstrgc = 0;
@@ -663,10 +815,11 @@ void luaC_fullgc (lua_State *L) {
 void luaC_barrierf (lua_State *L, GCObject *o, GCObject *v) {
   global_State *g = G(L);
   lua_assert(isblack(o) && iswhite(v) && !isdead(g, v) && !isdead(g, o));
-  lua_assert(g->gcstate != GCSfinalize && g->gcstate != GCSpause);
+  lua_assert(isgenerational(g) ||
+             (g->gcstate != GCSfinalize && g->gcstate != GCSpause));
   lua_assert(ttype(&o->gch) != LUA_TTABLE);
-  /* must keep invariant? */
-  if (g->gcstate == GCSpropagate)
+  /* must keep invariant? (always, in generational mode) */
+  if (g->gcstate == GCSpropagate || isgenerational(g))
     reallymarkobject(g, v);  /* restore invariant */
   else  /* don't mind */
     makewhite(g, o);  /* mark as white just to avoid other barriers */
@@ -677,7 +830,8 @@ void luaC_barrierback (lua_State *L, Table *t) {
   global_State *g = G(L);
   GCObject *o = obj2gco(t);
   lua_assert(isblack(o) && !isdead(g, o));
-  lua_assert(g->gcstate != GCSfinalize && g->gcstate != GCSpause);
+  lua_assert(isgenerational(g) ||
+             (g->gcstate != GCSfinalize && g->gcstate != GCSpause));
   black2gray(o);  /* make table gray (again) */
   t->gclist = g->grayagain;
   g->grayagain = o;
@@ -699,8 +853,9 @@ void luaC_linkupval (lua_State *L, UpVal *uv) {
   o->gch.next = g->rootgc;  /* link upvalue into `rootgc' list */
   g->rootgc = o;
   if (isgray(o)) { 
-    if (g->gcstate == GCSpropagate) {
+    if (g->gcstate == GCSpropagate || isgenerational(g)) {
       gray2black(o);  /* closed upvalues need barrier */
+      resetbit(o->gch.marked, OLDBIT);  /* now ahead of the young ones */
       luaC_barrier(L, uv, uv->v);
     }
     else {  /* sweep phase: sweep it (turning it into white) */
@@ -38,6 +38,7 @@ void luaS_resize (lua_State *L, int newsize) {
       lua_assert(cast_int(h%newsize) == lmod(h, newsize));
       p->gch.next = newhash[h1];  /* chain it */
       newhash[h1] = p;
+      resetbit(p->gch.marked, OLDBIT);  /* no longer behind the young ones */
       p = next;
     }
   }
@@ -313,6 +313,14 @@
 #define LUAI_GCMUL	200 /* GC runs 'twice the speed' of memory allocation */
 
 
+/*
+@@ LUAI_GCMINOR defines the size of the young generation in generational
+@* mode, as a percentage of the memory in use after the last collection.
+** CHANGE it if you want minor collections to run more or less often.
+*/
+#define LUAI_GCMINOR	25  /* 25% */
+
+
 
 /*
 @@ LUA_COMPAT_GETN controls compatibility with old getn behavior.
@@ -34,6 +34,12 @@ extern "C"
 #include <conprint.h>
 
 #include "inc/LuaEngine.h"
+#include "MemoryTracker.h"
+#include "LuaAllocator.h"
+
+// Allocations run the collector again once the heap grows
+// this many times past where the next cycle should start.
+#define GC_BEHIND_FACTOR 2
 
 namespace MobileLua
 {
@@ -156,6 +162,32 @@ static void RegFun(
 	lua_setglobal(L, funName);
 }
 
+/**
+ * Lua allocator that charges the interpreter's memory to
+ * the Lua tag of the memory tracker.
+ */
+static void* luaTrackedAlloc(void *ud, void *ptr, size_t osize, size_t nsize)
+{
+	if (nsize == 0)
+	{
+		memFree(ptr);
+		return NULL;
+	}
+
+	return memRealloc(ptr, nsize, MEMTAG_LUA);
+}
+
+/**
+ * Called on unprotected Lua errors.
+ */
+static int luaPanic(lua_State *L)
+{
+	lprintfln("PANIC: unprotected error in call to Lua API (%s)\n",
+		lua_tostring(L, -1));
+	maPanic(-1, "PANIC: unprotected error in call to Lua API");
+	return 0;
+}
+
 // ========== Implementation of Lua primitives ==========
 
 /**
@@ -207,9 +239,10 @@ static int luaStringToBuffer(lua_State *L)
 	// Get pointer to Lua string.
 	const char* s = luaL_checkstring(L, 1);
 
-	// Allocate new string buffer.
-	int size = strlen(s);
-	char* s2 = (char*) malloc(sizeof(char) * size);
+	// Allocate new string buffer, with the null termination
+	// character. Scripts keep it, so it stays charged to Lua.
+	int size = strlen(s) + 1;
+	char* s2 = (char*) memAlloc(sizeof(char) * size, MEMTAG_LUA);
 
 	// Copy to buffer.
 	strcpy(s2, s);
@@ -391,6 +424,7 @@ static void registerNativeFunctions(lua_State* L)
 	RegTableFun(L, "mosync", "SysLuaEngineDelete", luaEngineDelete);
 	RegTableFun(L, "mosync", "SysLuaEngineEval", luaEngineEval);
 	RegTableFun(L, "engine", "TestFunc", TestFunc);
+	RegTableFun(L, "engine", "GetRenderStats", GetRenderStats);
 }
 
 // ========== Constructor/Destructor ==========
@@ -400,7 +434,13 @@ static void registerNativeFunctions(lua_State* L)
  */
 LuaEngine::LuaEngine() :
 	mLuaState(NULL),
-	mLuaErrorListener(NULL)
+	mLuaErrorListener(NULL),
+	mAllocationGC(true),
+	mGCBaseKB(0),
+	mGCCycleRunning(false),
+	mGCMinorMilliseconds(0),
+	mPooledAllocator(false),
+	mAllocator(NULL)
 {
 }
 
@@ -465,23 +505,37 @@ LuaEngine::~LuaEngine()
  */
 int LuaEngine::initialize()
 {
-	lua_State* L = (lua_State*) mLuaState;
+	lua_State* L;
 
 	// Deallocate previous Lua state, if it exists.
-	if (L)
-	{
-		lua_close(L);
-		mLuaState = NULL;
-	}
+	shutdown();
 
 	// Create Lua state.
-	L = lua_open();
+	if (mPooledAllocator)
+	{
+		mAllocator = new LuaAllocator();
+		L = lua_newstate(LuaAllocator::alloc, mAllocator);
+	}
+	else
+	{
+		L = lua_newstate(luaTrackedAlloc, NULL);
+	}
 	mLuaState = L;
 	if (!L)
 	{
 		return 0;
 	}
 
+	lua_atpanic(L, luaPanic);
+
+	if (!mAllocationGC)
+	{
+		lua_gc(L, LUA_GCSTOP, 0);
+	}
+	mGCBaseKB = 0;
+	mGCCycleRunning = false;
+	mGCMinorMilliseconds = 0;
+
 	luaL_openlibs(L);
 
 	registerNativeFunctions(L);
@@ -506,6 +560,10 @@ void LuaEngine::shutdown()
 		mLuaState = NULL;
 	}
 
+	// The state has freed all its blocks.
+	delete mAllocator;
+	mAllocator = NULL;
+
 	// TODO: Free function closures.
 	// We can skip this as we close the entire interpreter, but
 	// remember to free old functions when new ones are set.
@@ -530,7 +588,7 @@ int LuaEngine::eval(const char* script)
 	//   "return (10)"
 	//   "x = 10 "
 	int length = strlen(script);
-	char* s = (char*) malloc(length + 2);
+	char* s = (char*) memAlloc(length + 2, MEMTAG_LUA);
 	strcpy(s, script);
 	s[length] = ' ';
 	s[length + 1] = 0;
@@ -539,7 +597,7 @@ int LuaEngine::eval(const char* script)
 	int result = luaL_dostring(L, s);
 
 	// Free temporary script string.
-	free(s);
+	memFree(s);
 
 	// Was there an error?
 	if (0 != result)
@@ -570,6 +628,133 @@ int LuaEngine::eval(const char* script)
 	return result == 0;
 }
 
+/**
+ * The pause the collector waits for between cycles, as a
+ * percentage of the heap after the last one.
+ */
+static int getGCPause(lua_State *L)
+{
+	int pause = lua_gc(L, LUA_GCSETPAUSE, 0);
+	lua_gc(L, LUA_GCSETPAUSE, pause);
+	return pause;
+}
+
+/**
+ * Run the garbage collector for about the given number of
+ * microseconds.
+ * @return Non-zero if a collection cycle finished.
+ */
+int LuaEngine::collectGarbage(int budgetMicroseconds)
+{
+	lua_State* L = (lua_State*) mLuaState;
+	if (!L)
+	{
+		return 0;
+	}
+
+	// The clock only counts milliseconds, so the budget is
+	// too. A step is far shorter than that, so the clock is
+	// read after each one.
+	int budget = budgetMicroseconds / 1000;
+	int start = maGetMilliSecondCount();
+	bool generational = (lua_gc(L, LUA_GCMODE, 0) == LUA_GCGEN);
+
+	// Where the collector would start the next collection: a
+	// minor one once the young objects reach LUAI_GCMINOR percent
+	// of the heap, or a new cycle after the pause.
+	int growth = generational ? LUAI_GCMINOR : getGCPause(L) - 100;
+	int dueKB = mGCBaseKB + mGCBaseKB * growth / 100;
+	int count = lua_gc(L, LUA_GCCOUNT, 0);
+
+	int finished = 0;
+	if (generational)
+	{
+		// A step is a whole minor collection and can't be cut
+		// short. Run it once it is due and the last one fitted
+		// in a budget this size.
+		if (count >= dueKB && mGCMinorMilliseconds <= budget)
+		{
+			lua_gc(L, LUA_GCSTEP, 0);
+			mGCMinorMilliseconds = maGetMilliSecondCount() - start;
+			finished = 1;
+		}
+		else if (count >= dueKB)
+		{
+			// Don't hold one long collection, a major one,
+			// against all the minor ones after it.
+			mGCMinorMilliseconds /= 2;
+		}
+	}
+	else if (mGCCycleRunning || count >= dueKB)
+	{
+		mGCCycleRunning = true;
+		while (maGetMilliSecondCount() - start < budget)
+		{
+			if (lua_gc(L, LUA_GCSTEP, 0))
+			{
+				finished = 1;
+				mGCCycleRunning = false;
+				break;
+			}
+		}
+	}
+
+	if (finished)
+	{
+		mGCBaseKB = lua_gc(L, LUA_GCCOUNT, 0);
+	}
+
+	// Hand the slabs collections emptied back to the heap, a few
+	// at a time in what is left of the budget.
+	if (mAllocator)
+	{
+		while (mAllocator->getEmptySlabs() > 0 &&
+			maGetMilliSecondCount() - start < budget)
+		{
+			mAllocator->trim();
+		}
+	}
+
+	// Stepping set the collector going again. Stop it, unless
+	// the budget has not kept up with the scripts.
+	if (!mAllocationGC)
+	{
+		if (!finished && mGCBaseKB > 0 &&
+			lua_gc(L, LUA_GCCOUNT, 0) > dueKB * GC_BEHIND_FACTOR)
+		{
+			lua_gc(L, LUA_GCRESTART, 0);
+		}
+		else
+		{
+			lua_gc(L, LUA_GCSTOP, 0);
+		}
+	}
+
+	return finished;
+}
+
+/**
+ * Let the collector also run while scripts allocate.
+ */
+void LuaEngine::setAllocationGC(bool enabled)
+{
+	mAllocationGC = enabled;
+
+	lua_State* L = (lua_State*) mLuaState;
+	if (L)
+	{
+		lua_gc(L, enabled ? LUA_GCRESTART : LUA_GCSTOP, 0);
+	}
+}
+
+/**
+ * Give the next Lua state a pooled allocator.
+ */
+void LuaEngine::setPooledAllocator(bool enabled)
+{
+	mPooledAllocator = enabled;
+}
+
 /**
  * Set a listener that will get notified when there is a
  * Lua error.
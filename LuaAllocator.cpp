@@ -0,0 +1,414 @@
+/*
+ * LuaAllocator.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include <mastdlib.h>
+#include <conprint.h>
+#include "LuaAllocator.h"
+#include "MemoryTracker.h"
+
+#define LUA_ALLOC_LARGE LUA_ALLOC_NUM_CLASSES
+
+// At the start of every slab, followed by its blocks.
+struct luaAllocSlab{
+	// Neighbours in the class's list of slabs with free blocks,
+	// next also links the empty and spare slabs.
+	luaAllocSlab *prev;
+	luaAllocSlab *next;
+	luaAllocRegion *region;
+	// Freed blocks, linked through their first word.
+	void *free;
+	short sizeClass;
+	short liveBlocks;
+	// Blocks the slab holds, and the ones handed out so far,
+	// the rest are not on the free list yet.
+	short capacity;
+	short carved;
+};
+
+// At the start of every region, before its first aligned slab.
+struct luaAllocRegion{
+	luaAllocRegion *prev;
+	luaAllocRegion *next;
+	// Slabs not in use by any class, linked through next.
+	luaAllocSlab *spare;
+	int spareSlabs;
+};
+
+// Keeps the blocks as aligned as the slab.
+#define LUA_ALLOC_SLAB_HEADER \
+	((sizeof(luaAllocSlab) + LUA_ALLOC_GRANULE - 1) & ~(LUA_ALLOC_GRANULE - 1))
+
+// Enough for the region header and its slabs at any alignment.
+#define LUA_ALLOC_REGION_SIZE (sizeof(luaAllocRegion) + \
+	LUA_ALLOC_REGION_SLABS * LUA_ALLOC_SLAB_SIZE + LUA_ALLOC_SLAB_SIZE - 1)
+
+static int sizeClassOf(size_t size)
+{
+	return (int)(size - 1) / LUA_ALLOC_GRANULE;
+}
+
+static int blockSizeOf(int sizeClass)
+{
+	return (sizeClass + 1) * LUA_ALLOC_GRANULE;
+}
+
+static int blocksPerSlab(int sizeClass)
+{
+	return (LUA_ALLOC_SLAB_SIZE - LUA_ALLOC_SLAB_HEADER) / blockSizeOf(sizeClass);
+}
+
+static luaAllocSlab* slabOf(void *ptr)
+{
+	return (luaAllocSlab *)((size_t)ptr & ~(size_t)(LUA_ALLOC_SLAB_SIZE - 1));
+}
+
+static void linkRegion(luaAllocRegion *&head, luaAllocRegion *region)
+{
+	region->prev = NULL;
+	region->next = head;
+	if(head != NULL)
+	{
+		head->prev = region;
+	}
+	head = region;
+}
+
+static void unlinkRegion(luaAllocRegion *&head, luaAllocRegion *region)
+{
+	if(region->prev != NULL)
+	{
+		region->prev->next = region->next;
+	}
+	else
+	{
+		head = region->next;
+	}
+	if(region->next != NULL)
+	{
+		region->next->prev = region->prev;
+	}
+}
+
+static void countAlloc(luaAllocStats *stats, int size)
+{
+	stats->liveBlocks++;
+	stats->liveBytes += size;
+	stats->totalAllocations++;
+	if(stats->liveBlocks > stats->peakBlocks)
+	{
+		stats->peakBlocks = stats->liveBlocks;
+	}
+}
+
+static void countFree(luaAllocStats *stats, int size)
+{
+	stats->liveBlocks--;
+	stats->liveBytes -= size;
+}
+
+LuaAllocator::LuaAllocator():
+	mEmpty(NULL),
+	mEmptySlabs(0),
+	mSpareRegions(NULL),
+	mFullRegions(NULL),
+	mNumRegions(0)
+{
+	memset(mStats, 0, sizeof(mStats));
+	for(int i = 0; i < LUA_ALLOC_NUM_CLASSES; i++)
+	{
+		mPartial[i] = NULL;
+		mStats[i].blockSize = blockSizeOf(i);
+	}
+}
+
+LuaAllocator::~LuaAllocator()
+{
+	while(mSpareRegions != NULL)
+	{
+		luaAllocRegion *region = mSpareRegions;
+		mSpareRegions = region->next;
+		memFree(region);
+	}
+	while(mFullRegions != NULL)
+	{
+		luaAllocRegion *region = mFullRegions;
+		mFullRegions = region->next;
+		memFree(region);
+	}
+}
+
+void* LuaAllocator::alloc(void *ud, void *ptr, size_t osize, size_t nsize)
+{
+	return ((LuaAllocator *)ud)->realloc(ptr, osize, nsize);
+}
+
+void* LuaAllocator::realloc(void *ptr, size_t osize, size_t nsize)
+{
+	if(ptr == NULL)
+	{
+		osize = 0;
+	}
+	bool wasSmall = osize <= LUA_ALLOC_MAX_SMALL;
+	bool isSmall = nsize <= LUA_ALLOC_MAX_SMALL;
+
+	if(nsize == 0)
+	{
+		if(ptr == NULL)
+		{
+			return NULL;
+		}
+		if(wasSmall)
+		{
+			freeSmall(ptr, sizeClassOf(osize));
+		}
+		else
+		{
+			memFree(ptr);
+			countFree(&mStats[LUA_ALLOC_LARGE], osize);
+		}
+		return NULL;
+	}
+
+	if(ptr != NULL && wasSmall && isSmall && sizeClassOf(osize) == sizeClassOf(nsize))
+	{
+		return ptr;
+	}
+	if(ptr != NULL && !wasSmall && !isSmall)
+	{
+		void *block = memRealloc(ptr, nsize, MEMTAG_LUA);
+		if(block != NULL)
+		{
+			mStats[LUA_ALLOC_LARGE].liveBytes += (int)nsize - (int)osize;
+		}
+		return block;
+	}
+
+	// A new block, or one that changes size class.
+	void *block;
+	if(isSmall)
+	{
+		block = allocSmall(sizeClassOf(nsize));
+	}
+	else
+	{
+		block = memAlloc(nsize, MEMTAG_LUA);
+		if(block != NULL)
+		{
+			countAlloc(&mStats[LUA_ALLOC_LARGE], nsize);
+		}
+	}
+	if(block == NULL || ptr == NULL)
+	{
+		return block;
+	}
+	memcpy(block, ptr, (osize < nsize) ? osize : nsize);
+	realloc(ptr, osize, 0);
+	return block;
+}
+
+void* LuaAllocator::allocSmall(int sizeClass)
+{
+	luaAllocSlab *slab = mPartial[sizeClass];
+	if(slab == NULL)
+	{
+		slab = newSlab(sizeClass);
+		if(slab == NULL)
+		{
+			return NULL;
+		}
+		linkPartial(slab);
+	}
+	void *block = slab->free;
+	if(block != NULL)
+	{
+		slab->free = *(void **)block;
+	}
+	else
+	{
+		block = (char *)slab + LUA_ALLOC_SLAB_HEADER +
+			slab->carved++ * blockSizeOf(sizeClass);
+	}
+	if(++slab->liveBlocks == slab->capacity)
+	{
+		unlinkPartial(slab);
+	}
+	countAlloc(&mStats[sizeClass], blockSizeOf(sizeClass));
+	return block;
+}
+
+void LuaAllocator::freeSmall(void *ptr, int sizeClass)
+{
+	luaAllocSlab *slab = slabOf(ptr);
+	if(slab->liveBlocks == slab->capacity)
+	{
+		linkPartial(slab);
+	}
+	*(void **)ptr = slab->free;
+	slab->free = ptr;
+	if(--slab->liveBlocks == 0)
+	{
+		unlinkPartial(slab);
+		slab->next = mEmpty;
+		mEmpty = slab;
+		mEmptySlabs++;
+		mStats[sizeClass].slabs--;
+	}
+	countFree(&mStats[sizeClass], blockSizeOf(sizeClass));
+}
+
+void LuaAllocator::linkPartial(luaAllocSlab *slab)
+{
+	luaAllocSlab *&head = mPartial[slab->sizeClass];
+	slab->prev = NULL;
+	slab->next = head;
+	if(head != NULL)
+	{
+		head->prev = slab;
+	}
+	head = slab;
+}
+
+void LuaAllocator::unlinkPartial(luaAllocSlab *slab)
+{
+	if(slab->prev != NULL)
+	{
+		slab->prev->next = slab->next;
+	}
+	else
+	{
+		mPartial[slab->sizeClass] = slab->next;
+	}
+	if(slab->next != NULL)
+	{
+		slab->next->prev = slab->prev;
+	}
+}
+
+/**
+ * A slab for the class, with no blocks handed out: an empty one
+ * if there is one, else one spared by a region.
+ */
+luaAllocSlab* LuaAllocator::newSlab(int sizeClass)
+{
+	luaAllocSlab *slab = mEmpty;
+	if(slab != NULL)
+	{
+		mEmpty = slab->next;
+		mEmptySlabs--;
+	}
+	else
+	{
+		slab = takeSpareSlab();
+		if(slab == NULL)
+		{
+			return NULL;
+		}
+	}
+	slab->free = NULL;
+	slab->sizeClass = sizeClass;
+	slab->liveBlocks = 0;
+	slab->capacity = blocksPerSlab(sizeClass);
+	slab->carved = 0;
+	mStats[sizeClass].slabs++;
+	return slab;
+}
+
+luaAllocSlab* LuaAllocator::takeSpareSlab()
+{
+	luaAllocRegion *region = mSpareRegions;
+	if(region == NULL)
+	{
+		region = (luaAllocRegion *)memAlloc(LUA_ALLOC_REGION_SIZE, MEMTAG_LUA);
+		if(region == NULL)
+		{
+			return NULL;
+		}
+		region->spare = NULL;
+		region->spareSlabs = LUA_ALLOC_REGION_SLABS;
+		size_t first = ((size_t)(region + 1) + LUA_ALLOC_SLAB_SIZE - 1) &
+			~(size_t)(LUA_ALLOC_SLAB_SIZE - 1);
+		for(int i = LUA_ALLOC_REGION_SLABS - 1; i >= 0; i--)
+		{
+			luaAllocSlab *slab = (luaAllocSlab *)(first + i * LUA_ALLOC_SLAB_SIZE);
+			slab->region = region;
+			slab->next = region->spare;
+			region->spare = slab;
+		}
+		linkRegion(mSpareRegions, region);
+		mNumRegions++;
+	}
+	luaAllocSlab *slab = region->spare;
+	region->spare = slab->next;
+	if(--region->spareSlabs == 0)
+	{
+		unlinkRegion(mSpareRegions, region);
+		linkRegion(mFullRegions, region);
+	}
+	return slab;
+}
+
+/**
+ * Hand an empty slab back to its region, releasing the region
+ * if none of its slabs are in use any more.
+ */
+void LuaAllocator::releaseSlab(luaAllocSlab *slab)
+{
+	luaAllocRegion *region = slab->region;
+	slab->next = region->spare;
+	region->spare = slab;
+	if(region->spareSlabs++ == 0)
+	{
+		unlinkRegion(mFullRegions, region);
+		linkRegion(mSpareRegions, region);
+	}
+	if(region->spareSlabs == LUA_ALLOC_REGION_SLABS)
+	{
+		unlinkRegion(mSpareRegions, region);
+		memFree(region);
+		mNumRegions--;
+	}
+}
+
+int LuaAllocator::trim()
+{
+	int released = 0;
+	while(mEmpty != NULL && released < LUA_ALLOC_TRIM_BATCH)
+	{
+		luaAllocSlab *slab = mEmpty;
+		mEmpty = slab->next;
+		mEmptySlabs--;
+		releaseSlab(slab);
+		released++;
+	}
+	return released;
+}
+
+int LuaAllocator::getSlabBytes() const
+{
+	return mNumRegions * LUA_ALLOC_REGION_SLABS * LUA_ALLOC_SLAB_SIZE;
+}
+
+void LuaAllocator::dump() const
+{
+	for(int i = 0; i < LUA_ALLOC_NUM_CLASSES; i++)
+	{
+		const luaAllocStats &stats = mStats[i];
+		if(stats.totalAllocations == 0)
+		{
+			continue;
+		}
+		lprintfln("lua alloc %5d live:%d peak:%d allocs:%d slabs:%d",
+			stats.blockSize,
+			stats.liveBlocks,
+			stats.peakBlocks,
+			stats.totalAllocations,
+			stats.slabs);
+	}
+	const luaAllocStats &large = mStats[LUA_ALLOC_LARGE];
+	lprintfln("lua alloc large live:%d peak:%d allocs:%d bytes:%d",
+		large.liveBlocks, large.peakBlocks, large.totalAllocations, large.liveBytes);
+	lprintfln("lua alloc slabs:%d bytes", getSlabBytes());
+}
@@ -0,0 +1,125 @@
+/*
+ * LuaAllocator.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef LUAALLOCATOR_H_
+#define LUAALLOCATOR_H_
+
+#include <ma.h>
+
+// Blocks up to LUA_ALLOC_MAX_SMALL bytes come from slabs, in
+// size classes LUA_ALLOC_GRANULE bytes apart.
+#define LUA_ALLOC_GRANULE 8
+#define LUA_ALLOC_MAX_SMALL 256
+#define LUA_ALLOC_NUM_CLASSES (LUA_ALLOC_MAX_SMALL / LUA_ALLOC_GRANULE)
+#define LUA_ALLOC_SLAB_SIZE 4096
+// Slabs are carved from regions of this many, aligned to their
+// size so the slab holding a block is found from its address.
+#define LUA_ALLOC_REGION_SLABS 16
+// Empty slabs trim() releases at most per call.
+#define LUA_ALLOC_TRIM_BATCH 8
+
+struct luaAllocStats{
+	// Size of the class's blocks, 0 for the large blocks.
+	int blockSize;
+	int liveBlocks;
+	int liveBytes;
+	int peakBlocks;
+	int totalAllocations;
+	// Slabs the class holds.
+	int slabs;
+};
+
+struct luaAllocSlab;
+struct luaAllocRegion;
+
+/**
+ * A lua_Alloc for the interpreter's many small strings, tables,
+ * nodes and closures.
+ *
+ * Small blocks are carved from slabs that hold blocks of one
+ * size class, so freeing them leaves no holes in the heap that
+ * only a smaller block fits. Lua passes the old size of every
+ * block it frees or resizes, so the blocks carry no header.
+ * Larger blocks go to memRealloc. Slabs and large blocks are
+ * charged to MEMTAG_LUA.
+ *
+ * Slabs are LUA_ALLOC_SLAB_SIZE aligned, so freeing a block
+ * masks its address to find its slab. A slab whose last block
+ * is freed goes on the empty list, to be reused by any class.
+ * trim() hands empty slabs back to their region, and a region
+ * is released once none of its slabs are in use.
+ */
+class LuaAllocator
+{
+public:
+	LuaAllocator();
+
+	/**
+	 * Releases the slabs, the Lua state must be closed.
+	 */
+	~LuaAllocator();
+
+	/**
+	 * The lua_Alloc to pass to lua_newstate, with the allocator
+	 * as its user data.
+	 */
+	static void* alloc(void *ud, void *ptr, size_t osize, size_t nsize);
+
+	void* realloc(void *ptr, size_t osize, size_t nsize);
+
+	/**
+	 * Hand up to LUA_ALLOC_TRIM_BATCH empty slabs back to their
+	 * regions, call it again while getEmptySlabs() is not 0.
+	 * @return The number of slabs handed back.
+	 */
+	int trim();
+
+	int getEmptySlabs() const { return mEmptySlabs; }
+
+	/**
+	 * Statistics of a size class, from 0 to LUA_ALLOC_NUM_CLASSES - 1,
+	 * or of the large blocks with LUA_ALLOC_NUM_CLASSES.
+	 */
+	const luaAllocStats& getStats(int sizeClass) const { return mStats[sizeClass]; }
+
+	/**
+	 * Bytes taken by slab regions, used or not.
+	 */
+	int getSlabBytes() const;
+
+	/**
+	 * Print the classes in use to the console.
+	 */
+	void dump() const;
+
+private:
+	void* allocSmall(int sizeClass);
+
+	void freeSmall(void *ptr, int sizeClass);
+
+	luaAllocSlab* newSlab(int sizeClass);
+
+	luaAllocSlab* takeSpareSlab();
+
+	void releaseSlab(luaAllocSlab *slab);
+
+	void linkPartial(luaAllocSlab *slab);
+
+	void unlinkPartial(luaAllocSlab *slab);
+
+	// Slabs of each class with free blocks.
+	luaAllocSlab *mPartial[LUA_ALLOC_NUM_CLASSES];
+	// Slabs with no blocks in use, waiting for trim().
+	luaAllocSlab *mEmpty;
+	int mEmptySlabs;
+	luaAllocStats mStats[LUA_ALLOC_NUM_CLASSES + 1];
+	// Regions with slabs to spare, and the ones without.
+	luaAllocRegion *mSpareRegions;
+	luaAllocRegion *mFullRegions;
+	int mNumRegions;
+};
+
+#endif /* LUAALLOCATOR_H_ */
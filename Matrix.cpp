@@ -0,0 +1,133 @@
+/*
+ * Matrix.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include <madmath.h>
+#include "Matrix.h"
+#include "Renderer.h"
+
+void Matrix::identity(float *m)
+{
+	for(int i = 0; i < 16; i++)
+	{
+		m[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+	}
+}
+
+void Matrix::multiply(float *result, const float *a, const float *b)
+{
+	for(int col = 0; col < 4; col++)
+	{
+		for(int row = 0; row < 4; row++)
+		{
+			result[col * 4 + row] =
+				a[row] * b[col * 4] +
+				a[4 + row] * b[col * 4 + 1] +
+				a[8 + row] * b[col * 4 + 2] +
+				a[12 + row] * b[col * 4 + 3];
+		}
+	}
+}
+
+void Matrix::frustum(float *m, float left, float right,
+	float bottom, float top, float zNear, float zFar)
+{
+	identity(m);
+	m[0] = 2.0f * zNear / (right - left);
+	m[5] = 2.0f * zNear / (top - bottom);
+	m[8] = (right + left) / (right - left);
+	m[9] = (top + bottom) / (top - bottom);
+	m[10] = -(zFar + zNear) / (zFar - zNear);
+	m[11] = -1.0f;
+	m[14] = -2.0f * zFar * zNear / (zFar - zNear);
+	m[15] = 0.0f;
+}
+
+void Matrix::perspective(float *m, float fovy, float aspect,
+	float zNear, float zFar)
+{
+	float ymax = zNear * tan(fovy * M_PI / 360.0);
+	float xmax = ymax * aspect;
+	frustum(m, -xmax, xmax, -ymax, ymax, zNear, zFar);
+}
+
+void Matrix::transformPoint(float *result, const float *m,
+	float x, float y, float z)
+{
+	for(int row = 0; row < 4; row++)
+	{
+		result[row] = m[row] * x + m[4 + row] * y + m[8 + row] * z + m[12 + row];
+	}
+}
+
+static float clampUnit(float value)
+{
+	return (value > 1.0f) ? 1.0f : ((value < -1.0f) ? -1.0f : value);
+}
+
+CameraMatrices::CameraMatrices():
+	mValid(false),
+	mProjectionChanged(false),
+	mVersion(0)
+{
+	Matrix::identity(mView);
+	Matrix::identity(mProjection);
+	Matrix::identity(mViewProjection);
+}
+
+void CameraMatrices::setPerspective(float fovy, float aspect, float zNear, float zFar)
+{
+	Matrix::perspective(mProjection, fovy, aspect, zNear, zFar);
+	mProjectionChanged = true;
+}
+
+bool CameraMatrices::update(const camera *c)
+{
+	bool moved = !mValid ||
+		mPosition[0] != c->position.x ||
+		mPosition[1] != c->position.y ||
+		mPosition[2] != c->position.z ||
+		mFacing[0] != c->facing.x ||
+		mFacing[1] != c->facing.y;
+	if(!moved && !mProjectionChanged)
+	{
+		return false;
+	}
+
+	if(moved)
+	{
+		mPosition[0] = c->position.x;
+		mPosition[1] = c->position.y;
+		mPosition[2] = c->position.z;
+		mFacing[0] = c->facing.x;
+		mFacing[1] = c->facing.y;
+
+		// Pitch by asin(facing.y) around x, then yaw by asin(facing.x)
+		// around y, then move the world opposite to the camera.
+		float sx = clampUnit(c->facing.y);
+		float cx = sqrt(1.0f - sx * sx);
+		float sy = clampUnit(c->facing.x);
+		float cy = sqrt(1.0f - sy * sy);
+		float rotateX[16], rotateY[16], translate[16], rotation[16];
+		Matrix::identity(rotateX);
+		rotateX[5] = cx;  rotateX[6] = sx;
+		rotateX[9] = -sx; rotateX[10] = cx;
+		Matrix::identity(rotateY);
+		rotateY[0] = cy;  rotateY[2] = -sy;
+		rotateY[8] = sy;  rotateY[10] = cy;
+		Matrix::identity(translate);
+		translate[12] = -c->position.x;
+		translate[13] = -c->position.y;
+		translate[14] = -c->position.z;
+		Matrix::multiply(rotation, rotateX, rotateY);
+		Matrix::multiply(mView, rotation, translate);
+	}
+
+	Matrix::multiply(mViewProjection, mProjection, mView);
+	mValid = true;
+	mProjectionChanged = false;
+	mVersion++;
+	return true;
+}
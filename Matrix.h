@@ -0,0 +1,89 @@
+/*
+ * Matrix.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef MATRIX_H_
+#define MATRIX_H_
+
+struct camera;
+
+/**
+ * 4x4 matrix helpers. Matrices are arrays of 16 floats in
+ * column major order, like GL's, so they can be handed to
+ * glLoadMatrixf directly.
+ */
+class Matrix
+{
+public:
+	static void identity(float *m);
+
+	/**
+	 * result = a * b. result must not be a or b.
+	 */
+	static void multiply(float *result, const float *a, const float *b);
+
+	/**
+	 * The matrix glFrustumf would multiply in.
+	 */
+	static void frustum(float *m, float left, float right,
+		float bottom, float top, float zNear, float zFar);
+
+	/**
+	 * The matrix gluPerspective would multiply in.
+	 */
+	static void perspective(float *m, float fovy, float aspect,
+		float zNear, float zFar);
+
+	/**
+	 * Transform the point (x, y, z, 1), result has four components.
+	 */
+	static void transformPoint(float *result, const float *m,
+		float x, float y, float z);
+};
+
+/**
+ * The view, projection and combined view-projection matrices
+ * of a camera. They are only recomputed when the camera or
+ * the projection changes, and can be used by culling and
+ * picking without reading anything back from GL.
+ */
+class CameraMatrices
+{
+public:
+	CameraMatrices();
+
+	void setPerspective(float fovy, float aspect, float zNear, float zFar);
+
+	/**
+	 * Recompute the view matrices if the camera moved.
+	 * @return true if anything changed since the last update.
+	 */
+	bool update(const camera *c);
+
+	const float* getView() const { return mView; }
+
+	const float* getProjection() const { return mProjection; }
+
+	const float* getViewProjection() const { return mViewProjection; }
+
+	/**
+	 * Increases every time the matrices change.
+	 */
+	int getVersion() const { return mVersion; }
+
+private:
+	float mView[16];
+	float mProjection[16];
+	float mViewProjection[16];
+
+	bool mValid;
+	bool mProjectionChanged;
+	// The camera the view matrix was computed for.
+	float mPosition[3];
+	float mFacing[2];
+	int mVersion;
+};
+
+#endif /* MATRIX_H_ */
@@ -0,0 +1,285 @@
+/*
+ * MemoryTracker.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include <mastdlib.h>
+#include <conprint.h>
+#include <new>
+#include "MemoryTracker.h"
+
+#define MEMORY_HEADER_MAGIC 0x4D54
+
+// Stored right in front of every tracked block.
+struct memoryHeader{
+	int size;
+	short tag;
+	short magic;
+};
+
+// Bytes reserved in front of every tracked block for its header,
+// the alignment malloc gives: 8 on the device, 16 on 64 bit
+// hosts, so the block keeps it.
+#define MEMORY_HEADER_SPACE (2 * sizeof(void *))
+
+static void* blockOf(memoryHeader *header)
+{
+	return (char *)(header + 1) - MEMORY_HEADER_SPACE;
+}
+
+static memoryHeader* headerOf(void *block)
+{
+	return (memoryHeader *)((char *)block + MEMORY_HEADER_SPACE) - 1;
+}
+
+// Plain zero initialized data, so tracking works for allocations
+// made by static constructors before main runs.
+static memoryStats sStats[MEMTAG_COUNT];
+static memoryStats sTotal;
+static int sLastSampleAllocations[MEMTAG_COUNT + 1];
+static int sLastSampleTime;
+static int sBudget;
+static bool sOverBudget;
+static bool sInBudgetCallback;
+static MemoryBudgetListener *sBudgetListener;
+static MemoryTag sCurrentTag = MEMTAG_GENERAL;
+
+static const char* sTagNames[MEMTAG_COUNT] = {
+	"general",
+	"terrain",
+	"lua",
+	"net",
+	"ui",
+	"render"
+};
+
+static void account(memoryStats *stats, int size)
+{
+	stats->liveBytes += size;
+	if(size > 0)
+	{
+		stats->liveAllocations++;
+		stats->totalAllocations++;
+		if(stats->liveBytes > stats->peakBytes)
+		{
+			stats->peakBytes = stats->liveBytes;
+		}
+	}
+	else
+	{
+		stats->liveAllocations--;
+	}
+}
+
+static void checkBudget()
+{
+	if(sBudget <= 0)
+	{
+		return;
+	}
+	if(sTotal.liveBytes <= sBudget)
+	{
+		sOverBudget = false;
+		return;
+	}
+	if(!sOverBudget && !sInBudgetCallback && sBudgetListener != NULL)
+	{
+		sOverBudget = true;
+		// The listener may allocate, don't call it recursively.
+		sInBudgetCallback = true;
+		sBudgetListener->memoryBudgetExceeded(sTotal.liveBytes, sBudget);
+		sInBudgetCallback = false;
+	}
+}
+
+extern "C" void* memAlloc(size_t size, int tag)
+{
+	void *block = malloc(MEMORY_HEADER_SPACE + size);
+	if(block == NULL)
+	{
+		return NULL;
+	}
+	memoryHeader *header = headerOf(block);
+	header->size = size;
+	header->tag = tag;
+	header->magic = MEMORY_HEADER_MAGIC;
+	account(&sStats[tag], size);
+	account(&sTotal, size);
+	checkBudget();
+	return header + 1;
+}
+
+extern "C" void memFree(void *ptr)
+{
+	if(ptr == NULL)
+	{
+		return;
+	}
+	memoryHeader *header = ((memoryHeader *)ptr) - 1;
+	if(header->magic != MEMORY_HEADER_MAGIC)
+	{
+		maPanic(0, "memFree: block was not allocated by the memory tracker");
+	}
+	account(&sStats[header->tag], -header->size);
+	account(&sTotal, -header->size);
+	header->magic = 0;
+	free(blockOf(header));
+	checkBudget();
+}
+
+extern "C" void* memRealloc(void *ptr, size_t size, int tag)
+{
+	if(ptr == NULL)
+	{
+		return memAlloc(size, tag);
+	}
+	if(size == 0)
+	{
+		memFree(ptr);
+		return NULL;
+	}
+	memoryHeader *header = ((memoryHeader *)ptr) - 1;
+	if(header->magic != MEMORY_HEADER_MAGIC)
+	{
+		maPanic(0, "memRealloc: block was not allocated by the memory tracker");
+	}
+	int oldSize = header->size;
+	int oldTag = header->tag;
+	void *block = realloc(blockOf(header), MEMORY_HEADER_SPACE + size);
+	if(block == NULL)
+	{
+		return NULL;
+	}
+	header = headerOf(block);
+	// Charge the block to the new tag as if it was freed and allocated again,
+	// without counting it as a new allocation.
+	sStats[oldTag].liveBytes -= oldSize;
+	sStats[oldTag].liveAllocations--;
+	sStats[tag].liveAllocations++;
+	sStats[tag].liveBytes += size;
+	if(sStats[tag].liveBytes > sStats[tag].peakBytes)
+	{
+		sStats[tag].peakBytes = sStats[tag].liveBytes;
+	}
+	sTotal.liveBytes += (int)size - oldSize;
+	if(sTotal.liveBytes > sTotal.peakBytes)
+	{
+		sTotal.peakBytes = sTotal.liveBytes;
+	}
+	header->size = size;
+	header->tag = tag;
+	checkBudget();
+	return header + 1;
+}
+
+void* operator new(size_t size)
+{
+	void *ptr = memAlloc(size, sCurrentTag);
+	if(ptr == NULL)
+	{
+		maPanic(0, "operator new: out of memory");
+	}
+	return ptr;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&)
+{
+	return memAlloc(size, sCurrentTag);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&)
+{
+	return memAlloc(size, sCurrentTag);
+}
+
+void operator delete(void *ptr)
+{
+	memFree(ptr);
+}
+
+void operator delete[](void *ptr)
+{
+	memFree(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t&)
+{
+	memFree(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t&)
+{
+	memFree(ptr);
+}
+
+void MemoryTracker::setBudget(int bytes, MemoryBudgetListener *listener)
+{
+	sBudget = bytes;
+	sBudgetListener = listener;
+	sOverBudget = false;
+	checkBudget();
+}
+
+const memoryStats& MemoryTracker::getStats(MemoryTag tag)
+{
+	return sStats[tag];
+}
+
+const memoryStats& MemoryTracker::getTotalStats()
+{
+	return sTotal;
+}
+
+const char* MemoryTracker::getTagName(MemoryTag tag)
+{
+	return sTagNames[tag];
+}
+
+MemoryTag MemoryTracker::getCurrentTag()
+{
+	return sCurrentTag;
+}
+
+void MemoryTracker::setCurrentTag(MemoryTag tag)
+{
+	sCurrentTag = tag;
+}
+
+void MemoryTracker::sample()
+{
+	int now = maGetMilliSecondCount();
+	int elapsed = now - sLastSampleTime;
+	if(elapsed <= 0)
+	{
+		return;
+	}
+	for(int i = 0; i <= MEMTAG_COUNT; i++)
+	{
+		memoryStats *stats = (i < MEMTAG_COUNT) ? &sStats[i] : &sTotal;
+		stats->allocationRate =
+			(stats->totalAllocations - sLastSampleAllocations[i]) * 1000 / elapsed;
+		sLastSampleAllocations[i] = stats->totalAllocations;
+	}
+	sLastSampleTime = now;
+}
+
+void MemoryTracker::dump()
+{
+	for(int i = 0; i < MEMTAG_COUNT; i++)
+	{
+		lprintfln("mem %-8s live:%d peak:%d blocks:%d allocs/s:%d",
+			sTagNames[i],
+			sStats[i].liveBytes,
+			sStats[i].peakBytes,
+			sStats[i].liveAllocations,
+			sStats[i].allocationRate);
+	}
+	lprintfln("mem total    live:%d peak:%d budget:%d",
+		sTotal.liveBytes, sTotal.peakBytes, sBudget);
+}
@@ -0,0 +1,107 @@
+/*
+ * MemoryTracker.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef MEMORYTRACKER_H_
+#define MEMORYTRACKER_H_
+
+#include <ma.h>
+
+// Heap budget we want to stay under, the device heap is 3 MB.
+#define MEMORY_DEFAULT_BUDGET (2560 * 1024)
+
+/**
+ * The subsystem an allocation is charged to.
+ */
+enum MemoryTag
+{
+	MEMTAG_GENERAL,
+	MEMTAG_TERRAIN,
+	MEMTAG_LUA,
+	MEMTAG_NET,
+	MEMTAG_UI,
+	MEMTAG_RENDER,
+	MEMTAG_COUNT
+};
+
+struct memoryStats{
+	int liveBytes;
+	int peakBytes;
+	int liveAllocations;
+	int totalAllocations;
+	// Allocations per second, updated by MemoryTracker::sample().
+	int allocationRate;
+};
+
+/**
+ * Called when the live heap goes over the budget. It is
+ * called once per crossing, not for every allocation.
+ */
+class MemoryBudgetListener
+{
+public:
+	virtual void memoryBudgetExceeded(int liveBytes, int budget) = 0;
+};
+
+/**
+ * Accounts every heap allocation made through operator new/delete
+ * and the mem* functions below to the current MemoryTag.
+ */
+class MemoryTracker
+{
+public:
+	static void setBudget(int bytes, MemoryBudgetListener *listener);
+
+	static const memoryStats& getStats(MemoryTag tag);
+
+	static const memoryStats& getTotalStats();
+
+	static const char* getTagName(MemoryTag tag);
+
+	static MemoryTag getCurrentTag();
+
+	static void setCurrentTag(MemoryTag tag);
+
+	/**
+	 * Update the allocation rates, call this periodically.
+	 */
+	static void sample();
+
+	/**
+	 * Print the per tag counters to the console.
+	 */
+	static void dump();
+};
+
+/**
+ * Charges all allocations made during its lifetime to tag.
+ */
+class MemoryTagScope
+{
+public:
+	MemoryTagScope(MemoryTag tag)
+	{
+		mPrevious = MemoryTracker::getCurrentTag();
+		MemoryTracker::setCurrentTag(tag);
+	}
+
+	~MemoryTagScope()
+	{
+		MemoryTracker::setCurrentTag(mPrevious);
+	}
+
+private:
+	MemoryTag mPrevious;
+};
+
+/**
+ * Tracked replacements for malloc/realloc/free, for C code and
+ * allocator callbacks that know which subsystem they serve.
+ */
+extern "C" void* memAlloc(size_t size, int tag);
+extern "C" void* memRealloc(void *ptr, size_t size, int tag);
+extern "C" void memFree(void *ptr);
+
+#endif /* MEMORYTRACKER_H_ */
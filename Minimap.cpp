@@ -0,0 +1,80 @@
+/*
+ * Minimap.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include <ma.h>
+#include "Minimap.h"
+#include "GLStateCache.h"
+
+Minimap::Minimap():
+	mTexture(0),
+	mDirty(true)
+{
+	mMin[0] = mMin[1] = 0.0f;
+	mMax[0] = mMax[1] = 1.0f;
+}
+
+void Minimap::contextLost()
+{
+	mTexture = 0;
+	mDirty = true;
+}
+
+void Minimap::capture(GLStateCache *state, const float *min, const float *max)
+{
+	if(mTexture == 0)
+	{
+		glGenTextures(1, &mTexture);
+		state->bindTexture(mTexture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, MINIMAP_SIZE, MINIMAP_SIZE, 0,
+			GL_RGB, GL_UNSIGNED_BYTE, NULL);
+		glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
+	state->bindTexture(mTexture);
+	glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, MINIMAP_SIZE, MINIMAP_SIZE);
+
+	for(int i = 0; i < 2; i++)
+	{
+		mMin[i] = min[i];
+		mMax[i] = max[i];
+	}
+	mDirty = false;
+}
+
+void Minimap::draw(GLStateCache *state, const float *rect, float x, float y)
+{
+	GLfloat vertices[] = {
+		rect[0], rect[1], rect[2], rect[1], rect[0], rect[3], rect[2], rect[3]
+	};
+	static const GLfloat texcoords[] = {0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f};
+
+	state->enable(GL_TEXTURE_2D);
+	state->bindTexture(mTexture);
+	state->bindBuffer(GL_ARRAY_BUFFER, 0);
+	state->enableClientState(GL_VERTEX_ARRAY);
+	state->enableClientState(GL_TEXTURE_COORD_ARRAY);
+	state->disableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(2, GL_FLOAT, 0, vertices);
+	glTexCoordPointer(2, GL_FLOAT, 0, texcoords);
+	state->drawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+	// The lander, as a point over the map.
+	float u = (x - mMin[0]) / (mMax[0] - mMin[0]);
+	float v = (y - mMin[1]) / (mMax[1] - mMin[1]);
+	u = (u < 0.0f) ? 0.0f : ((u > 1.0f) ? 1.0f : u);
+	v = (v < 0.0f) ? 0.0f : ((v > 1.0f) ? 1.0f : v);
+	GLfloat marker[] = {
+		rect[0] + (rect[2] - rect[0]) * u, rect[1] + (rect[3] - rect[1]) * v
+	};
+	state->disable(GL_TEXTURE_2D);
+	glPointSize(MINIMAP_MARKER_SIZE);
+	glColor4f(1.0f, 0.2f, 0.2f, 1.0f);
+	glVertexPointer(2, GL_FLOAT, 0, marker);
+	state->drawArrays(GL_POINTS, 0, 1);
+	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+}
@@ -0,0 +1,71 @@
+/*
+ * Minimap.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef MINIMAP_H_
+#define MINIMAP_H_
+
+#include <GLES/gl.h>
+
+class GLStateCache;
+
+// Side of the map texture, and of the view it's rendered at.
+#define MINIMAP_SIZE 128
+// Side of the map on screen, as a fraction of the view's
+// smaller side.
+#define MINIMAP_SCREEN_FRACTION 0.3f
+#define MINIMAP_MARKER_SIZE 6.0f
+
+/**
+ * A top-down map of the terrain in a corner of the screen.
+ *
+ * The terrain is rendered from above once, copied into a
+ * texture and then drawn as a single quad every frame, with a
+ * point marking the lander. It is rendered again only after
+ * the terrain or its lighting changed, or the context was lost.
+ */
+class Minimap
+{
+public:
+	Minimap();
+
+	/**
+	 * The terrain changed, render it again before the next draw.
+	 */
+	void invalidate() { mDirty = true; }
+
+	/**
+	 * The texture went with the GL context.
+	 */
+	void contextLost();
+
+	bool needsUpdate() const { return mDirty; }
+
+	bool isReady() const { return mTexture != 0 && !mDirty; }
+
+	/**
+	 * Copy the lower left MINIMAP_SIZE square of the framebuffer,
+	 * where the terrain was just rendered from above with the
+	 * area from min to max filling it.
+	 */
+	void capture(GLStateCache *state, const float *min, const float *max);
+
+	/**
+	 * Draw the map into rect, left, bottom, right and top in
+	 * normalized device coordinates, with the marker at (x, y) on
+	 * the terrain. The matrices must be identities. Vertex and
+	 * texture coordinate arrays are left enabled.
+	 */
+	void draw(GLStateCache *state, const float *rect, float x, float y);
+
+private:
+	GLuint mTexture;
+	bool mDirty;
+	// The terrain area in the texture.
+	float mMin[2];
+	float mMax[2];
+};
+
+#endif /* MINIMAP_H_ */
@@ -0,0 +1,248 @@
+/*
+ * ParticleSystem.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include <ma.h>
+#include <mastdlib.h>
+#include "ParticleSystem.h"
+#include "Renderer.h"
+#include "GLStateCache.h"
+#include "MemoryTracker.h"
+
+#define PARTICLE_GRAVITY 1.0f
+#define PARTICLE_EXHAUST_LIFE 1.0f
+#define PARTICLE_DUST_LIFE 2.0f
+// Fraction of the speed a dust particle keeps when bouncing.
+#define PARTICLE_BOUNCE 0.3f
+#define PARTICLE_SIZE 3.0f
+
+#define NO_TERRAIN -1000000.0f
+
+ParticleSystem::ParticleSystem(int capacity):
+	mCapacity(capacity),
+	mCount(0),
+	mDropped(0),
+	mLandscape(NULL),
+	mOriginX(0.0f),
+	mOriginY(0.0f),
+	mSegmentSize(1.0f),
+	mSeed(12345)
+{
+	MemoryTagScope scope(MEMTAG_RENDER);
+	mX = new float[capacity];
+	mY = new float[capacity];
+	mZ = new float[capacity];
+	mVX = new float[capacity];
+	mVY = new float[capacity];
+	mVZ = new float[capacity];
+	mLife = new float[capacity];
+	mKind = new unsigned char[capacity];
+	mPositions = new GLfloat[capacity * 3];
+	mColors = new GLubyte[capacity * 4];
+}
+
+ParticleSystem::~ParticleSystem()
+{
+	delete[] mX;
+	delete[] mY;
+	delete[] mZ;
+	delete[] mVX;
+	delete[] mVY;
+	delete[] mVZ;
+	delete[] mLife;
+	delete[] mKind;
+	delete[] mPositions;
+	delete[] mColors;
+}
+
+void ParticleSystem::setLandscape(landscape *ls)
+{
+	mLandscape = ls;
+	if(ls != NULL && ls->numSegments > 0)
+	{
+		mOriginX = ls->segments[0].vcoords[0][0];
+		mOriginY = ls->segments[0].vcoords[0][1];
+		mSegmentSize = ls->segments[0].vcoords[1][0] - ls->segments[0].vcoords[0][0];
+	}
+}
+
+/**
+ * A number in [-1, 1) from a linear congruential generator,
+ * cheaper than rand() and good enough for spreading particles.
+ */
+float ParticleSystem::random()
+{
+	mSeed = mSeed * 1664525 + 1013904223;
+	return (int)(mSeed >> 8) / 8388608.0f - 1.0f;
+}
+
+int ParticleSystem::emit(ParticleKind kind, const float *position, const float *velocity,
+	float spread, int count)
+{
+	if(count > mCapacity - mCount)
+	{
+		mDropped += count - (mCapacity - mCount);
+		count = mCapacity - mCount;
+	}
+	float life = (kind == PARTICLE_EXHAUST) ? PARTICLE_EXHAUST_LIFE : PARTICLE_DUST_LIFE;
+	for(int i = mCount; i < mCount + count; i++)
+	{
+		mX[i] = position[0];
+		mY[i] = position[1];
+		mZ[i] = position[2];
+		mVX[i] = velocity[0] + random() * spread;
+		mVY[i] = velocity[1] + random() * spread;
+		mVZ[i] = velocity[2] + random() * spread;
+		// Spread the deaths out a little.
+		mLife[i] = life * (0.75f + 0.25f * random());
+		mKind[i] = kind;
+	}
+	mCount += count;
+	return count;
+}
+
+/**
+ * Replace particle i with the last one.
+ */
+void ParticleSystem::kill(int i)
+{
+	int last = --mCount;
+	mX[i] = mX[last];
+	mY[i] = mY[last];
+	mZ[i] = mZ[last];
+	mVX[i] = mVX[last];
+	mVY[i] = mVY[last];
+	mVZ[i] = mVZ[last];
+	mLife[i] = mLife[last];
+	mKind[i] = mKind[last];
+}
+
+void ParticleSystem::update(float dt)
+{
+	int count = mCount;
+
+	// Integrate. Plain loops over separate arrays, with no
+	// branches, so the compiler can keep them tight.
+	float gravity = PARTICLE_GRAVITY * dt;
+	for(int i = 0; i < count; i++)
+	{
+		mVZ[i] -= gravity;
+	}
+	for(int i = 0; i < count; i++)
+	{
+		mX[i] += mVX[i] * dt;
+		mY[i] += mVY[i] * dt;
+		mZ[i] += mVZ[i] * dt;
+	}
+	for(int i = 0; i < count; i++)
+	{
+		mLife[i] -= dt;
+	}
+
+	// Age and collide. Walking backwards, a dead particle is
+	// replaced by one that has already been processed.
+	for(int i = count - 1; i >= 0; i--)
+	{
+		if(mLife[i] <= 0.0f)
+		{
+			kill(i);
+			continue;
+		}
+		if(mLandscape == NULL)
+		{
+			continue;
+		}
+		float ground = terrainHeight(mX[i], mY[i]);
+		if(mZ[i] < ground)
+		{
+			mZ[i] = ground;
+			if(mKind[i] == PARTICLE_EXHAUST)
+			{
+				// Kick up dust, thrown out sideways.
+				mKind[i] = PARTICLE_DUST;
+				mLife[i] = PARTICLE_DUST_LIFE * (0.75f + 0.25f * random());
+				float speed = -mVZ[i];
+				mVX[i] += random() * speed;
+				mVY[i] += random() * speed;
+			}
+			mVX[i] *= PARTICLE_BOUNCE;
+			mVY[i] *= PARTICLE_BOUNCE;
+			mVZ[i] = (mVZ[i] < 0.0f) ? -mVZ[i] * PARTICLE_BOUNCE : mVZ[i];
+		}
+	}
+}
+
+float ParticleSystem::terrainHeight(float x, float y) const
+{
+	int side = mLandscape->segmentsPerSide;
+	float gx = (x - mOriginX) / mSegmentSize;
+	float gy = (y - mOriginY) / mSegmentSize;
+	if(gx < 0.0f || gy < 0.0f || gx >= side || gy >= side)
+	{
+		return NO_TERRAIN;
+	}
+	int sx = (int)gx;
+	int sy = (int)gy;
+	float u = gx - sx;
+	float v = gy - sy;
+	const GLfloat (*corner)[3] = mLandscape->segments[sx * side + sy].vcoords;
+	// The segment is split along its 1-3 diagonal.
+	if(u + v <= 1.0f)
+	{
+		return corner[0][2] + u * (corner[1][2] - corner[0][2]) + v * (corner[3][2] - corner[0][2]);
+	}
+	return corner[2][2] + (1.0f - u) * (corner[3][2] - corner[2][2]) +
+		(1.0f - v) * (corner[1][2] - corner[2][2]);
+}
+
+void ParticleSystem::draw(GLStateCache *state)
+{
+	if(mCount == 0)
+	{
+		return;
+	}
+
+	// Pack positions and fading colors for GL.
+	for(int i = 0; i < mCount; i++)
+	{
+		mPositions[i * 3] = mX[i];
+		mPositions[i * 3 + 1] = mY[i];
+		mPositions[i * 3 + 2] = mZ[i];
+	}
+	for(int i = 0; i < mCount; i++)
+	{
+		float fade = mLife[i] * (1.0f / PARTICLE_DUST_LIFE);
+		fade = (fade > 1.0f) ? 1.0f : fade;
+		GLubyte *color = &mColors[i * 4];
+		if(mKind[i] == PARTICLE_EXHAUST)
+		{
+			color[0] = (GLubyte)(255 * fade);
+			color[1] = (GLubyte)(160 * fade);
+			color[2] = (GLubyte)(60 * fade);
+		}
+		else
+		{
+			color[0] = color[1] = color[2] = (GLubyte)(110 * fade);
+		}
+		color[3] = 255;
+	}
+
+	// Untextured, additive points. Hidden by the terrain, but they
+	// don't hide each other, the order doesn't matter when adding.
+	state->disable(GL_TEXTURE_2D);
+	state->disableClientState(GL_TEXTURE_COORD_ARRAY);
+	state->enableClientState(GL_COLOR_ARRAY);
+	state->enable(GL_BLEND);
+	state->bindBuffer(GL_ARRAY_BUFFER, 0);
+	glPointSize(PARTICLE_SIZE);
+	glVertexPointer(3, GL_FLOAT, 0, mPositions);
+	glColorPointer(4, GL_UNSIGNED_BYTE, 0, mColors);
+	glDepthMask(GL_FALSE);
+	state->drawArrays(GL_POINTS, 0, mCount);
+	glDepthMask(GL_TRUE);
+	state->disableClientState(GL_COLOR_ARRAY);
+	state->disable(GL_BLEND);
+	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+}
@@ -0,0 +1,117 @@
+/*
+ * ParticleSystem.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef PARTICLESYSTEM_H_
+#define PARTICLESYSTEM_H_
+
+#include <GLES/gl.h>
+
+struct landscape;
+class GLStateCache;
+
+// Particles the renderer's system can hold.
+#define PARTICLE_DEFAULT_CAPACITY 2048
+
+enum ParticleKind
+{
+	PARTICLE_EXHAUST,
+	PARTICLE_DUST
+};
+
+/**
+ * Engine exhaust and dust, simulated and drawn in bulk.
+ *
+ * Particles live in fixed size arrays allocated once, one array
+ * per attribute, and are kept packed at the front so every pass
+ * is a straight loop over the live ones. Dead particles are
+ * replaced by the last live one. When the pool is full new
+ * particles are dropped.
+ *
+ * Particles collide with the landscape. An exhaust particle
+ * that hits the ground turns into dust and bounces off sideways.
+ *
+ * All live particles are drawn with one glDrawArrays of points.
+ */
+class ParticleSystem
+{
+public:
+	ParticleSystem(int capacity = PARTICLE_DEFAULT_CAPACITY);
+
+	~ParticleSystem();
+
+	/**
+	 * The landscape particles collide with, NULL for none.
+	 */
+	void setLandscape(landscape *ls);
+
+	/**
+	 * Emit count particles at position, moving with velocity
+	 * plus a random velocity of up to spread in every direction.
+	 * @return The number of particles that fit in the pool.
+	 */
+	int emit(ParticleKind kind, const float *position, const float *velocity,
+		float spread, int count);
+
+	/**
+	 * Advance the particles by dt seconds.
+	 */
+	void update(float dt);
+
+	/**
+	 * Draw all particles. Vertex arrays must be enabled,
+	 * color arrays are enabled and disabled here.
+	 */
+	void draw(GLStateCache *state);
+
+	int getCount() const { return mCount; }
+
+	int getCapacity() const { return mCapacity; }
+
+	/**
+	 * Particles not emitted because the pool was full.
+	 */
+	int getDropped() const { return mDropped; }
+
+	/**
+	 * Height of the landscape at (x, y), from the triangle of
+	 * the segment below it. -1e6 off the landscape.
+	 */
+	float terrainHeight(float x, float y) const;
+
+private:
+	float random();
+
+	void kill(int i);
+
+	int mCapacity;
+	int mCount;
+	int mDropped;
+
+	// The particle attributes, one array each.
+	float *mX;
+	float *mY;
+	float *mZ;
+	float *mVX;
+	float *mVY;
+	float *mVZ;
+	float *mLife;
+	unsigned char *mKind;
+
+	// Packed for drawing.
+	GLfloat *mPositions;
+	GLubyte *mColors;
+
+	landscape *mLandscape;
+	// Grid of the landscape: corner of segment (0, 0)
+	// and the size of a segment.
+	float mOriginX;
+	float mOriginY;
+	float mSegmentSize;
+
+	unsigned int mSeed;
+};
+
+#endif /* PARTICLESYSTEM_H_ */
@@ -0,0 +1,96 @@
+/*
+ * RenderLoop.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include <ma.h>
+#include "RenderLoop.h"
+
+RenderLoop::RenderLoop():
+	mRenderer(NULL),
+	mIdleListener(NULL),
+	mRunning(false),
+	mLastSceneTime(-1),
+	mExhaustCarry(0.0f),
+	mFramesDrawn(0),
+	mFramesSkipped(0)
+{
+}
+
+RenderLoop::~RenderLoop()
+{
+	stop();
+}
+
+void RenderLoop::start(Renderer *renderer)
+{
+	mRenderer = renderer;
+	if(!mRunning)
+	{
+		Environment::getEnvironment().addTimer(this, RENDER_LOOP_PERIOD, 0);
+		mRunning = true;
+	}
+}
+
+void RenderLoop::stop()
+{
+	if(mRunning)
+	{
+		Environment::getEnvironment().removeTimer(this);
+		mRunning = false;
+	}
+}
+
+void RenderLoop::runTimerEvent()
+{
+	int frameStart = maGetMilliSecondCount();
+	if(!mScenes.acquire())
+	{
+		mFramesSkipped++;
+		return;
+	}
+
+	const sceneSnapshot &scene = mScenes.getFront();
+	mRenderer->setCamera(&scene.view);
+	updateParticles(scene);
+	mRenderer->draw();
+	mFramesDrawn++;
+
+	int left = RENDER_LOOP_PERIOD - (maGetMilliSecondCount() - frameStart);
+	if(mIdleListener != NULL && left > 0)
+	{
+		mIdleListener->frameIdle(left * 1000);
+	}
+}
+
+/**
+ * The particles are only for show, so they are advanced here
+ * from the snapshots rather than by the simulation.
+ */
+void RenderLoop::updateParticles(const sceneSnapshot &scene)
+{
+	float dt = (mLastSceneTime < 0) ? 0.0f : (scene.time - mLastSceneTime) / 1000.0f;
+	mLastSceneTime = scene.time;
+
+	ParticleSystem &particles = mRenderer->getParticles();
+	if(scene.enginesRunning)
+	{
+		// The engine pushes against the facing direction,
+		// so the exhaust goes out along it.
+		const vector &facing = scene.view.facing;
+		float position[3] = {
+			scene.landerPosition.x + facing.x,
+			scene.landerPosition.y + facing.y,
+			scene.landerPosition.z + facing.z};
+		float velocity[3] = {
+			scene.landerVelocity.x + facing.x * EXHAUST_SPEED,
+			scene.landerVelocity.y + facing.y * EXHAUST_SPEED,
+			scene.landerVelocity.z + facing.z * EXHAUST_SPEED};
+		mExhaustCarry += EXHAUST_RATE * dt;
+		int count = (int)mExhaustCarry;
+		mExhaustCarry -= count;
+		particles.emit(PARTICLE_EXHAUST, position, velocity, EXHAUST_SPREAD, count);
+	}
+	particles.update(dt);
+}
@@ -0,0 +1,106 @@
+/*
+ * RenderLoop.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef RENDERLOOP_H_
+#define RENDERLOOP_H_
+
+#include <MAUtil/Environment.h>
+#include "Renderer.h"
+#include "TripleBuffer.h"
+
+using namespace MAUtil;
+
+// Milliseconds between frames, about 60 Hz.
+#define RENDER_LOOP_PERIOD 16
+
+// Exhaust particles per second while the engine runs, how fast
+// they leave the nozzle and how much they scatter.
+#define EXHAUST_RATE 400.0f
+#define EXHAUST_SPEED 8.0f
+#define EXHAUST_SPREAD 1.5f
+
+/**
+ * Everything the renderer needs from one simulation step,
+ * copied so the simulation can go on changing its own state.
+ */
+struct sceneSnapshot{
+	int time;
+	camera view;
+	vector landerPosition;
+	vector landerVelocity;
+	bool enginesRunning;
+};
+
+/**
+ * Told after each frame is drawn how much of the frame period
+ * is left, for work that should not land in the middle of one.
+ */
+class FrameIdleListener
+{
+public:
+	virtual void frameIdle(int microseconds) = 0;
+};
+
+/**
+ * Draws frames on its own timer, decoupled from the simulation.
+ *
+ * The simulation fills a sceneSnapshot per step and publishes
+ * it, and never waits for rendering. Each frame the
+ * loop picks up the latest complete snapshot and draws it; if
+ * nothing was published since the last frame it skips drawing.
+ *
+ * MoSync gives applications no threads, and the GL context
+ * belongs to the event thread, so the loop runs as a timer on
+ * the same Environment as the simulation. The snapshots keep
+ * the two sides apart as if they were separate threads.
+ */
+class RenderLoop : public TimerListener
+{
+public:
+	RenderLoop();
+
+	virtual ~RenderLoop();
+
+	void start(Renderer *renderer);
+
+	void stop();
+
+	void setIdleListener(FrameIdleListener *listener) { mIdleListener = listener; }
+
+	/**
+	 * The snapshot the simulation fills next.
+	 */
+	sceneSnapshot& beginScene() { return mScenes.getBack(); }
+
+	/**
+	 * Hand the scene to the renderer.
+	 */
+	void publishScene() { mScenes.publish(); }
+
+	/**
+	 * Frames drawn, and timer ticks skipped for lack of a new scene.
+	 */
+	int getFramesDrawn() const { return mFramesDrawn; }
+
+	int getFramesSkipped() const { return mFramesSkipped; }
+
+	void runTimerEvent();
+
+private:
+	void updateParticles(const sceneSnapshot &scene);
+
+	Renderer *mRenderer;
+	FrameIdleListener *mIdleListener;
+	TripleBuffer<sceneSnapshot> mScenes;
+	bool mRunning;
+	int mLastSceneTime;
+	// Fraction of an exhaust particle left over from the last frame.
+	float mExhaustCarry;
+	int mFramesDrawn;
+	int mFramesSkipped;
+};
+
+#endif /* RENDERLOOP_H_ */
@@ -0,0 +1,108 @@
+/*
+ * RenderStats.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include <ma.h>
+#include <mastdlib.h>
+#include "RenderStats.h"
+#include "GLStateCache.h"
+
+RenderStats::RenderStats():
+	mNumFrames(0),
+	mNext(0)
+{
+	memset(&mLast, 0, sizeof(mLast));
+}
+
+void RenderStats::addFrame(const renderFrameStats &frame)
+{
+	mLast = frame;
+	mFrameTimes[mNext] = frame.frameTime;
+	mNext = (mNext + 1) & RENDER_STATS_HISTORY_MASK;
+	if(mNumFrames < RENDER_STATS_HISTORY)
+	{
+		mNumFrames++;
+	}
+}
+
+float RenderStats::getFPS() const
+{
+	int total = 0;
+	for(int i = 0; i < mNumFrames; i++)
+	{
+		total += mFrameTimes[i];
+	}
+	return (total > 0) ? mNumFrames * 1000.0f / total : 0.0f;
+}
+
+int RenderStats::getFrameTimePercentile(int percent) const
+{
+	if(mNumFrames == 0)
+	{
+		return 0;
+	}
+
+	// Insertion sort a copy, it's only asked for now and then.
+	int sorted[RENDER_STATS_HISTORY];
+	for(int i = 0; i < mNumFrames; i++)
+	{
+		int time = mFrameTimes[i];
+		int j = i;
+		while(j > 0 && sorted[j - 1] > time)
+		{
+			sorted[j] = sorted[j - 1];
+			j--;
+		}
+		sorted[j] = time;
+	}
+
+	int rank = (percent * mNumFrames + 99) / 100 - 1;
+	rank = (rank < 0) ? 0 : ((rank >= mNumFrames) ? mNumFrames - 1 : rank);
+	return sorted[rank];
+}
+
+void RenderStats::draw(GLStateCache *state, const float *rect)
+{
+	float width = rect[2] - rect[0];
+	float height = rect[3] - rect[1];
+	float scale = height / RENDER_STATS_GRAPH_MAX;
+
+	// Oldest frame on the left.
+	int first = (mNext - mNumFrames) & RENDER_STATS_HISTORY_MASK;
+	for(int i = 0; i < mNumFrames; i++)
+	{
+		int time = mFrameTimes[(first + i) & RENDER_STATS_HISTORY_MASK];
+		time = (time > RENDER_STATS_GRAPH_MAX) ? RENDER_STATS_GRAPH_MAX : time;
+		GLfloat x = rect[0] + width * (i + 0.5f) / RENDER_STATS_HISTORY;
+		GLfloat *v = &mGraphVertices[i * 4];
+		v[0] = x;
+		v[1] = rect[1];
+		v[2] = x;
+		v[3] = rect[1] + time * scale;
+		bool over = time > RENDER_STATS_BUDGET;
+		GLubyte *c = &mGraphColors[i * 8];
+		c[0] = c[4] = over ? 255 : 0;
+		c[1] = c[5] = over ? 0 : 255;
+		c[2] = c[6] = 0;
+		c[3] = c[7] = 255;
+	}
+	GLfloat *v = &mGraphVertices[mNumFrames * 4];
+	v[0] = rect[0];
+	v[2] = rect[2];
+	v[1] = v[3] = rect[1] + RENDER_STATS_BUDGET * scale;
+	GLubyte *c = &mGraphColors[mNumFrames * 8];
+	memset(c, 255, 8);
+
+	state->disable(GL_TEXTURE_2D);
+	state->bindBuffer(GL_ARRAY_BUFFER, 0);
+	state->enableClientState(GL_VERTEX_ARRAY);
+	state->disableClientState(GL_TEXTURE_COORD_ARRAY);
+	state->enableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(2, GL_FLOAT, 0, mGraphVertices);
+	glColorPointer(4, GL_UNSIGNED_BYTE, 0, mGraphColors);
+	state->drawArrays(GL_LINES, 0, (mNumFrames + 1) * 2);
+	state->disableClientState(GL_COLOR_ARRAY);
+	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+}
@@ -0,0 +1,89 @@
+/*
+ * RenderStats.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef RENDERSTATS_H_
+#define RENDERSTATS_H_
+
+#include <GLES/gl.h>
+
+class GLStateCache;
+
+// Frames the rolling figures cover, must be a power of two.
+#define RENDER_STATS_HISTORY 128
+#define RENDER_STATS_HISTORY_MASK (RENDER_STATS_HISTORY - 1)
+// Frame time in milliseconds drawn as the budget line of the
+// overlay, and at the top of it.
+#define RENDER_STATS_BUDGET 16
+#define RENDER_STATS_GRAPH_MAX 50
+
+// What one frame cost.
+struct renderFrameStats{
+	int drawCalls;
+	int vertices;
+	int indices;
+	int textureBinds;
+	int drawnChunks;
+	int culledChunks;
+	int occludedChunks;
+	// Milliseconds submitting, waiting for the GPU and present,
+	// and since the previous frame started.
+	int submitTime;
+	int waitTime;
+	int frameTime;
+};
+
+/**
+ * Keeps the cost of the last frame and the times of the recent
+ * ones, for FPS and frame time percentiles.
+ *
+ * The overlay is a graph of the recent frame times, one bar per
+ * frame, green within RENDER_STATS_BUDGET and red above it.
+ */
+class RenderStats
+{
+public:
+	RenderStats();
+
+	void addFrame(const renderFrameStats &frame);
+
+	const renderFrameStats& getLast() const { return mLast; }
+
+	/**
+	 * Frames in the rolling figures, up to RENDER_STATS_HISTORY.
+	 */
+	int getNumFrames() const { return mNumFrames; }
+
+	/**
+	 * Frames per second over the recent frames, 0 before any
+	 * time has passed.
+	 */
+	float getFPS() const;
+
+	/**
+	 * The frame time in milliseconds that percent of the recent
+	 * frames took at most.
+	 */
+	int getFrameTimePercentile(int percent) const;
+
+	/**
+	 * Draw the graph into rect, left, bottom, right and top in
+	 * normalized device coordinates. The matrices must be
+	 * identities. The vertex array is left enabled.
+	 */
+	void draw(GLStateCache *state, const float *rect);
+
+private:
+	renderFrameStats mLast;
+	int mFrameTimes[RENDER_STATS_HISTORY];
+	int mNumFrames;
+	// Where the next frame time goes.
+	int mNext;
+	// A bar per frame and the budget line.
+	GLfloat mGraphVertices[(RENDER_STATS_HISTORY + 1) * 4];
+	GLubyte mGraphColors[(RENDER_STATS_HISTORY + 1) * 8];
+};
+
+#endif /* RENDERSTATS_H_ */
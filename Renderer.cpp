@@ -8,6 +8,41 @@
 #include "Renderer.h"
 #include "MAHeaders.h"
 
+// The perspective projection.
+#define FIELD_OF_VIEW 45.0f
+#define Z_NEAR 0.1f
+#define Z_FAR 100.0f
+
+// Texture memory on top of what stays resident, for an atlas
+// of the small images.
+#define RENDERER_TEXTURE_HEADROOM \
+	(TEXTURE_ATLAS_SIZE * TEXTURE_ATLAS_SIZE * 4)
+
+Renderer::Renderer():
+	mGLView(NULL),
+	mLunarTexture(0),
+	mEnvironmentInitialized(false),
+	mCamera(NULL),
+	mLandscape(NULL),
+	mOcclusionCulling(true),
+	mTextures(&mGLState),
+	mAspect(1.0f),
+	mPixelsPerUnit(1.0f),
+	mMaxPixelError(TERRAIN_MAX_PIXEL_ERROR),
+	mViewWidth(0),
+	mViewHeight(0),
+	mViewportWidth(0),
+	mViewportHeight(0),
+	mSceneTexture(0),
+	mSceneTextureWidth(0),
+	mSceneTextureHeight(0),
+	mSceneTextureCharge(0),
+	mMinimapCharge(0),
+	mMinimapVisible(true),
+	mStatsOverlayVisible(false),
+	mLastFrameStart(0)
+{
+}
 
 void Renderer::init(GLView *glView)
 {
@@ -20,6 +55,25 @@ void Renderer::glViewReady(GLView *glView)
 	//Set this GLView to receive OpenGL commands
 	mGLView->bind();
 
+	// Nothing is known about the state of a new context,
+	// and none of the textures are in it.
+	mGLState.invalidate();
+	if(mSceneTextureCharge != 0)
+	{
+		mTextures.release(mSceneTextureCharge);
+		mSceneTextureCharge = 0;
+	}
+	if(mMinimapCharge != 0)
+	{
+		mTextures.release(mMinimapCharge);
+		mMinimapCharge = 0;
+	}
+	mTextures.invalidate();
+	mViewportWidth = 0;
+	mViewportHeight = 0;
+	mSceneTexture = 0;
+	mMinimap.contextLost();
+
 	// Create the texture we will use for rendering.
 	createTexture();
 
@@ -30,24 +84,69 @@ void Renderer::glViewReady(GLView *glView)
 void Renderer::setLandscape(landscape *ls)
 {
 	mLandscape = ls;
+	mParticles.setLandscape(ls);
+	// Deleting the buffers unbinds them, tell the state cache.
+	if(mTerrain.usesBufferObjects())
+	{
+		mGLState.bindBuffer(GL_ARRAY_BUFFER, 0);
+		mGLState.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+	// Rebuilt from the new landscape on the next draw.
+	mTerrain.release();
+	mMinimap.invalidate();
 }
 
-void Renderer::setCamera(camera *c)
+void Renderer::setTerrainVertexFormat(TerrainVertexFormat format)
+{
+	mTerrain.setVertexFormat(format);
+	setLandscape(mLandscape);
+}
+
+void Renderer::setSun(const vector &direction, float ambient)
+{
+	float sun[3] = {direction.x, direction.y, direction.z};
+	mTerrain.setLighting(sun, ambient);
+	mMinimap.invalidate();
+}
+
+void Renderer::setCamera(const camera *c)
 {
 	mCamera = c;
 }
 
-void Renderer::createTexture()
+static int nextPowerOfTwo(int n)
 {
-	// Create an OpenGL 2D texture from the image resource.
-	glEnable(GL_TEXTURE_2D);
-	glGenTextures(1, &mLunarTexture);
-	glBindTexture(GL_TEXTURE_2D, mLunarTexture);
-	maOpenGLTexImage2D(LUNAR_TEXTURE);
+	int power = 1;
+	while(power < n)
+	{
+		power *= 2;
+	}
+	return power;
+}
 
-	// Set texture parameters.
-	glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+void Renderer::createTexture()
+{
+	// A mipmapped OpenGL 2D texture from the image resource,
+	// or from its compressed version when the device can use it.
+	if(mLunarTexture == 0)
+	{
+#ifdef LUNAR_TEXTURE_KTX
+		mLunarTexture = mTextures.acquire(LUNAR_TEXTURE, LUNAR_TEXTURE_KTX);
+#else
+		mLunarTexture = mTextures.acquire(LUNAR_TEXTURE);
+#endif
+		// Small images among the ones registered share atlases.
+		mTextures.packAtlases();
+	}
+	// The budget holds the lunar texture, and the scene copy and
+	// minimap charged every frame, so only the rest is evicted.
+	int sceneBytes = nextPowerOfTwo(mGLView->getWidth()) *
+		nextPowerOfTwo(mGLView->getHeight()) * 3;
+	mTextures.setBudget(mTextures.getSize(mLunarTexture) + sceneBytes +
+		MINIMAP_SIZE * MINIMAP_SIZE * 3 + RENDERER_TEXTURE_HEADROOM);
+	// Load it now rather than in the first frame.
+	mGLState.enable(GL_TEXTURE_2D);
+	mTextures.bind(mLunarTexture);
 }
 
 /**
@@ -58,13 +157,18 @@ void Renderer::initGL()
 	//Configure the viewport
 	setViewport(mGLView->getWidth(), mGLView->getHeight());
     // Enable texture mapping.
-    glEnable(GL_TEXTURE_2D);
+    mGLState.enable(GL_TEXTURE_2D);
 
     // Enable smooth shading.
 	glShadeModel(GL_SMOOTH);
 
 	// Set the depth value used when clearing the depth buffer.
-	glClearDepthf(1.0f);
+	mGLState.clearDepth(1.0f);
+
+	// The terrain is drawn front to back, so the depth test
+	// rejects what is behind the chunks already drawn.
+	mGLState.enable(GL_DEPTH_TEST);
+	glDepthFunc(GL_LEQUAL);
 
 	//glEnable(GL_BLEND);
 
@@ -79,97 +183,293 @@ void Renderer::initGL()
 void Renderer::setViewport(int width, int height)
 {
 	// Set the viewport to fill the GLView
-	glViewport(0, 0, (GLint)width, (GLint)height);
+	mViewWidth = width;
+	mViewHeight = height;
+	applyViewport(width, height);
 
 	// Select the projection matrix.
-	glMatrixMode(GL_PROJECTION);
+	mGLState.matrixMode(GL_PROJECTION);
+
+	mAspect = (GLfloat)width / (GLfloat)height;
+	mPixelsPerUnit = height / (2.0f * tan(FIELD_OF_VIEW * M_PI / 360.0));
+	mMatrices.setPerspective(FIELD_OF_VIEW, mAspect, Z_NEAR, Z_FAR);
+	glLoadMatrixf(mMatrices.getProjection());
+}
+
+void Renderer::applyViewport(int width, int height)
+{
+	if(width != mViewportWidth || height != mViewportHeight)
+	{
+		glViewport(0, 0, (GLint)width, (GLint)height);
+		mViewportWidth = width;
+		mViewportHeight = height;
+	}
+}
+
+void Renderer::createSceneTexture()
+{
+	mSceneTextureWidth = nextPowerOfTwo(mViewWidth);
+	mSceneTextureHeight = nextPowerOfTwo(mViewHeight);
+
+	mSceneTextureCharge = mTextures.addExternal(
+		mSceneTextureWidth * mSceneTextureHeight * 3);
+	glGenTextures(1, &mSceneTexture);
+	mGLState.bindTexture(mSceneTexture);
+	// Storage only, every frame copies into it.
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, mSceneTextureWidth, mSceneTextureHeight,
+		0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+	glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+void Renderer::presentScaled(int width, int height)
+{
+	if(mSceneTexture == 0)
+	{
+		createSceneTexture();
+	}
 
-	// Reset the projection matrix.
+	// Grab the corner of the framebuffer the scene went to.
+	mGLState.bindTexture(mSceneTexture);
+	glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, width, height);
+
+	// And draw it back over the whole view.
+	applyViewport(mViewWidth, mViewHeight);
+	float s = (float)width / mSceneTextureWidth;
+	float t = (float)height / mSceneTextureHeight;
+	GLfloat vertices[] = {-1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
+	GLfloat texcoords[] = {0.0f, 0.0f, s, 0.0f, 0.0f, t, s, t};
+
+	mGLState.enable(GL_TEXTURE_2D);
+	mGLState.bindBuffer(GL_ARRAY_BUFFER, 0);
+	mGLState.enableClientState(GL_VERTEX_ARRAY);
+	mGLState.enableClientState(GL_TEXTURE_COORD_ARRAY);
+	mGLState.disableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(2, GL_FLOAT, 0, vertices);
+	glTexCoordPointer(2, GL_FLOAT, 0, texcoords);
+	mGLState.drawArrays(GL_TRIANGLE_STRIP, 0, 4);
+}
+
+void Renderer::loadScreenMatrices()
+{
+	mGLState.matrixMode(GL_PROJECTION);
 	glLoadIdentity();
+	mGLState.matrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+}
 
-	GLfloat ratio = (GLfloat)width / (GLfloat)height;
-	gluPerspective(45.0f, ratio, 0.1f, 100.0f);
+void Renderer::updateMinimap()
+{
+	if(!mTerrain.isBuilt())
+	{
+		mTerrain.build(mLandscape);
+	}
+
+	// Straight down onto the whole terrain, in the corner of the
+	// framebuffer the frame is about to clear anyway.
+	float min[3];
+	float max[3];
+	mTerrain.getBounds(min, max);
+	applyViewport(MINIMAP_SIZE, MINIMAP_SIZE);
+	mGLState.clearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	mGLState.matrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glOrthof(min[0], max[0], min[1], max[1], -max[2] - 1.0f, -min[2] + 1.0f);
+	mGLState.matrixMode(GL_MODELVIEW);
+	float identity[16];
+	Matrix::identity(identity);
+	glLoadMatrixf(identity);
+
+	mGLState.enable(GL_TEXTURE_2D);
+	mTextures.bind(mLunarTexture);
+	mGLState.enableClientState(GL_VERTEX_ARRAY);
+	mGLState.enableClientState(GL_TEXTURE_COORD_ARRAY);
+	mGLState.enableClientState(GL_COLOR_ARRAY);
+
+	// Heights don't show from above, only the lighting does, so
+	// every chunk at its finest level. It's drawn rarely.
+	float eye[3] = {(min[0] + max[0]) * 0.5f, (min[1] + max[1]) * 0.5f, max[2]};
+	mTerrain.selectLevels(eye, 1.0e6f, mMaxPixelError);
+	mTerrain.draw(NULL, NULL, &mGLState, identity);
+	mMinimap.capture(&mGLState, min, max);
+	if(mMinimapCharge == 0)
+	{
+		mMinimapCharge = mTextures.addExternal(MINIMAP_SIZE * MINIMAP_SIZE * 3);
+	}
+
+	mGLState.matrixMode(GL_PROJECTION);
+	glLoadMatrixf(mMatrices.getProjection());
 }
 
-/**
- * Standard OpenGL utility function for setting up the
- * perspective projection matrix.
- */
-void Renderer::gluPerspective(
-	GLfloat fovy,
-	GLfloat aspect,
-	GLfloat zNear,
-	GLfloat zFar)
+void Renderer::renderMinimap()
 {
-	//const float M_PI = 3.14159;
+	// A square in the top right corner, whatever the aspect ratio.
+	float side = MINIMAP_SCREEN_FRACTION *
+		((mViewWidth < mViewHeight) ? mViewWidth : mViewHeight);
+	float margin = side * 0.1f;
+	float rect[4];
+	rect[2] = 1.0f - 2.0f * margin / mViewWidth;
+	rect[3] = 1.0f - 2.0f * margin / mViewHeight;
+	rect[0] = rect[2] - 2.0f * side / mViewWidth;
+	rect[1] = rect[3] - 2.0f * side / mViewHeight;
+	mMinimap.draw(&mGLState, rect, mCamera->position.x, mCamera->position.y);
+}
 
-	GLfloat ymax = zNear * tan(fovy * M_PI / 360.0);
-	GLfloat ymin = -ymax;
-	GLfloat xmin = ymin * aspect;
-	GLfloat xmax = ymax * aspect;
+void Renderer::renderStatsOverlay()
+{
+	// Along the bottom, a tenth of the view high.
+	float rect[4] = {-0.95f, -0.95f, 0.95f, -0.75f};
+	mStats.draw(&mGLState, rect);
+}
 
-	glFrustumf(xmin, xmax, ymin, ymax, zNear, zFar);
+void Renderer::recordStats(int frameStart)
+{
+	const glSubmitCounters &counters = mGLState.getCounters();
+	renderFrameStats frame;
+	frame.drawCalls = counters.drawCalls;
+	frame.vertices = counters.vertices;
+	frame.indices = counters.indices;
+	frame.textureBinds = counters.textureBinds;
+	frame.drawnChunks = mTerrain.getDrawnChunks();
+	frame.culledChunks = mTerrain.getCulledChunks();
+	frame.occludedChunks = mTerrain.getOccludedChunks();
+	frame.submitTime = mFrameSync.getSubmitTime();
+	frame.waitTime = mFrameSync.getWaitTime();
+	frame.frameTime = (mLastFrameStart != 0) ? frameStart - mLastFrameStart : 0;
+	mLastFrameStart = frameStart;
+	mStats.addFrame(frame);
 }
 
 void Renderer::draw()
 {
 	if(mEnvironmentInitialized)
 	{
+		int frameStart = maGetMilliSecondCount();
+		mGLState.resetCounters();
+
+		// Time the submission and the wait for the GPU.
+		mFrameSync.beginFrame();
+		mTextures.beginFrame();
+
+		bool minimap = mMinimapVisible && mLandscape != NULL && mCamera != NULL;
+		if(minimap && mMinimap.needsUpdate())
+		{
+			updateMinimap();
+		}
+
+		// Render to a corner of the view when frames run long,
+		// the aspect ratio and projection stay the same.
+		float scale = mResolution.getScale();
+		int width = (int)(mViewWidth * scale + 0.5f);
+		int height = (int)(mViewHeight * scale + 0.5f);
+		applyViewport(width, height);
+
 		// Set the background color to be used when clearing the screen.
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		mGLState.clearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
 		// Clear the screen and the depth buffer.
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 		// Use the model matrix.
-		glMatrixMode(GL_MODELVIEW);
+		mGLState.matrixMode(GL_MODELVIEW);
 
-		// Reset the model matrix.
-		glLoadIdentity();
+		// Only recomputed when the camera moved.
+		if(mCamera != NULL && mMatrices.update(mCamera))
+		{
+			mFrustum.update(mMatrices.getViewProjection());
+		}
+		glLoadMatrixf(mMatrices.getView());
 
 		renderLandscape();
-		// Wait (blocks) until all GL drawing commands to finish.
-		glFinish();
+
+		renderParticles();
+
+		// Overlays drawn straight in normalized device coordinates.
+		bool scaled = (width != mViewWidth || height != mViewHeight);
+		if(scaled || minimap || mStatsOverlayVisible)
+		{
+			// Over the scene, whatever its depth.
+			mGLState.disable(GL_DEPTH_TEST);
+			loadScreenMatrices();
+			if(scaled)
+			{
+				presentScaled(width, height);
+			}
+			if(minimap)
+			{
+				renderMinimap();
+			}
+			if(mStatsOverlayVisible)
+			{
+				renderStatsOverlay();
+			}
+			mGLState.matrixMode(GL_PROJECTION);
+			glLoadMatrixf(mMatrices.getProjection());
+			mGLState.enable(GL_DEPTH_TEST);
+		}
+
+		// Flush instead of glFinish, so the next frame's simulation
+		// runs while the GPU works on this one.
+		mFrameSync.endFrame();
 
 		mGLView->redraw();
+
+		mFrameSync.framePresented();
+
+		// The next frame's resolution follows from this one's time.
+		mResolution.update(mFrameSync.getSubmitTime() + mFrameSync.getWaitTime());
+
+		recordStats(frameStart);
 	}
 }
 
 void Renderer::renderLandscape()
 {
-	// Array used to convert from QUAD to TRIANGLE_STRIP.
-	// QUAD is not available on the OpenGL implementation
-	// we are using.
-	GLubyte indices[4] = {0, 1, 3, 2};
-
-	// Select the texture to use when rendering the box.
-	glBindTexture(GL_TEXTURE_2D, mLunarTexture);
-
-
-	glPushMatrix();
-
-	glRotatef(180.0f * asin(mCamera->facing.y)/M_PI, 1.0f, 0.0f, 0.0f);
-	glRotatef(180.0f * asin(mCamera->facing.x)/M_PI, 0.0f, 1.0f, 0.0f);
-
-	glTranslatef(-mCamera->position.x, -mCamera->position.y, -mCamera->position.z);
-	//glScalef(20.0f, 20.0f, 0.0f);
-
-
+	if(mLandscape == NULL || mCamera == NULL)
+	{
+		return;
+	}
 
-	// Enable texture and vertex arrays
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	// Uploading needs the GL context, so do it on first use.
+	if(!mTerrain.isBuilt())
+	{
+		mTerrain.build(mLandscape);
+	}
 
-	for(int i = 0; i < mLandscape->numSegments; i++) {
-		// Set pointers to vertex coordinates and texture coordinates.
-		glVertexPointer(3, GL_FLOAT, 0, mLandscape->segments[i].vcoords);
-		glTexCoordPointer(2, GL_FLOAT, 0, mLandscape->segments[i].tcoords);
+	// Select the texture to use when rendering the box.
+	mGLState.enable(GL_TEXTURE_2D);
+	mTextures.bind(mLunarTexture);
+
+	// Enable texture and vertex arrays. They are left enabled,
+	// the state cache drops this after the first frame.
+	mGLState.enableClientState(GL_VERTEX_ARRAY);
+	mGLState.enableClientState(GL_TEXTURE_COORD_ARRAY);
+	// Baked lighting, modulating the texture.
+	mGLState.enableClientState(GL_COLOR_ARRAY);
+
+	// Coarser terrain further away, and only the chunks the camera can see.
+	float eye[3] = {mCamera->position.x, mCamera->position.y, mCamera->position.z};
+	// At a lower resolution the same error covers fewer pixels.
+	mTerrain.selectLevels(eye, mPixelsPerUnit * mResolution.getScale(), mMaxPixelError);
+	HorizonCuller *horizon = NULL;
+	if(mOcclusionCulling)
+	{
+		// Nothing past the far plane is drawn.
+		mHorizon.begin(eye, Z_FAR);
+		horizon = &mHorizon;
+	}
+	mTerrain.draw(&mFrustum, horizon, &mGLState, mMatrices.getView());
+}
 
-		// This draws the segment.
-		glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_BYTE, indices);
+void Renderer::renderParticles()
+{
+	if(mParticles.getCount() == 0)
+	{
+		return;
 	}
-	glPopMatrix();
-	// Disable texture and vertex arrays
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-	glDisableClientState(GL_VERTEX_ARRAY);
+	mGLState.enableClientState(GL_VERTEX_ARRAY);
+	mParticles.draw(&mGLState);
 }
@@ -12,6 +12,17 @@
 #include <NativeUI/GlViewListener.h>
 #include <GLES/gl.h>
 #include <madmath.h>
+#include "TerrainMesh.h"
+#include "Frustum.h"
+#include "HorizonCuller.h"
+#include "FrameSync.h"
+#include "GLStateCache.h"
+#include "TextureManager.h"
+#include "Matrix.h"
+#include "ParticleSystem.h"
+#include "ResolutionController.h"
+#include "Minimap.h"
+#include "RenderStats.h"
 
 using namespace NativeUI;
 
@@ -30,6 +41,9 @@ struct landSegment{
 
 struct landscape{
 	int numSegments;
+	// The segments form a square grid, segment (x, y)
+	// is at index x * segmentsPerSide + y.
+	int segmentsPerSide;
 	landSegment *segments;
 };
 
@@ -41,26 +55,136 @@ struct camera{
 class Renderer : public GLViewListener
 {
 public:
+	Renderer();
+
 	void init(GLView *glView);
 
 	void setLandscape(landscape *ls);
 
-	void setCamera(camera *c);
+	void setCamera(const camera *c);
+
+	/**
+	 * Screen space error in pixels the terrain level of detail
+	 * may introduce, TERRAIN_MAX_PIXEL_ERROR by default.
+	 */
+	void setTerrainDetail(float maxPixelError) { mMaxPixelError = maxPixelError; }
+
+	/**
+	 * Vertex format of the terrain, rebuilt on the next draw.
+	 */
+	void setTerrainVertexFormat(TerrainVertexFormat format);
+
+	/**
+	 * Light baked into the terrain: the direction towards the sun
+	 * and the ambient light, from 0 to 1.
+	 */
+	void setSun(const vector &direction, float ambient);
 
 	void glViewReady(GLView* glView);
 
 	void draw();
 
+	/**
+	 * Terrain chunks drawn and culled in the last frame.
+	 */
+	int getDrawnChunks() const { return mTerrain.getDrawnChunks(); }
+
+	int getCulledChunks() const { return mTerrain.getCulledChunks(); }
+
+	/**
+	 * Terrain chunks in view but hidden behind nearer terrain.
+	 */
+	int getOccludedChunks() const { return mTerrain.getOccludedChunks(); }
+
+	/**
+	 * Skip terrain hidden behind the horizon, on by default.
+	 */
+	void setOcclusionCulling(bool enabled) { mOcclusionCulling = enabled; }
+
+	/**
+	 * CPU time spent submitting the last frame and time
+	 * spent waiting for the GPU and present, in milliseconds.
+	 */
+	int getSubmitTime() const { return mFrameSync.getSubmitTime(); }
+
+	int getWaitTime() const { return mFrameSync.getWaitTime(); }
+
+	/**
+	 * GL state changes dropped so far because they changed nothing.
+	 */
+	int getEliminatedStateChanges() const { return mGLState.getEliminatedCalls(); }
+
+	/**
+	 * Exhaust and dust, drawn after the terrain.
+	 */
+	ParticleSystem& getParticles() { return mParticles; }
+
+	/**
+	 * The textures the renderer draws with.
+	 */
+	TextureManager& getTextures() { return mTextures; }
+
+	/**
+	 * The matrices of the last frame, for picking and culling.
+	 */
+	const CameraMatrices& getCameraMatrices() const { return mMatrices; }
+
+	/**
+	 * Picks the resolution the scene is rendered at from the
+	 * frame times, set its bounds and target here.
+	 */
+	ResolutionController& getResolution() { return mResolution; }
+
+	/**
+	 * Fraction of the view's width and height the last frame
+	 * was rendered at.
+	 */
+	float getResolutionScale() const { return mResolution.getScale(); }
+
+	/**
+	 * Show the terrain map in the top right corner, on by default.
+	 */
+	void setMinimapVisible(bool visible) { mMinimapVisible = visible; }
+
+	/**
+	 * What the last frames cost: draw calls, vertices, culling,
+	 * timing, FPS and frame time percentiles.
+	 */
+	const RenderStats& getStats() const { return mStats; }
+
+	/**
+	 * Graph the frame times along the bottom of the view,
+	 * off by default.
+	 */
+	void setStatsOverlayVisible(bool visible) { mStatsOverlayVisible = visible; }
+
 private:
 	void setViewport(int width, int height);
 
-	void gluPerspective(
-		GLfloat fovy,
-		GLfloat aspect,
-		GLfloat zNear,
-		GLfloat zFar);
+	void applyViewport(int width, int height);
+
+	// Stretch a scene rendered at a lower resolution over the view.
+	void presentScaled(int width, int height);
+
+	void createSceneTexture();
+
+	// Identity projection and modelview, for drawing in
+	// normalized device coordinates.
+	void loadScreenMatrices();
+
+	// Render the terrain from above into the minimap.
+	void updateMinimap();
+
+	void renderMinimap();
+
+	void renderStatsOverlay();
+
+	// Fill in the statistics of the frame that started at frameStart.
+	void recordStats(int frameStart);
 
 	void renderLandscape();
+
+	void renderParticles();
 	// Create the texture we will use for rendering.
 	void createTexture();
 
@@ -68,10 +192,43 @@ private:
 	void initGL();
 
 	GLView *mGLView;
-	GLuint mLunarTexture;
+	TextureHandle mLunarTexture;
 	bool mEnvironmentInitialized;
-	camera *mCamera;
+	const camera *mCamera;
 	landscape *mLandscape;
+	TerrainMesh mTerrain;
+	Frustum mFrustum;
+	HorizonCuller mHorizon;
+	bool mOcclusionCulling;
+	CameraMatrices mMatrices;
+	ParticleSystem mParticles;
+	FrameSync mFrameSync;
+	GLStateCache mGLState;
+	TextureManager mTextures;
+	GLfloat mAspect;
+	// Pixels per unit at distance one, for terrain detail.
+	GLfloat mPixelsPerUnit;
+	float mMaxPixelError;
+	ResolutionController mResolution;
+	// Size of the GLView, and of the viewport currently set.
+	int mViewWidth;
+	int mViewHeight;
+	int mViewportWidth;
+	int mViewportHeight;
+	// Copy of a scaled scene, the smallest power of two size
+	// that holds the whole view.
+	GLuint mSceneTexture;
+	int mSceneTextureWidth;
+	int mSceneTextureHeight;
+	Minimap mMinimap;
+	// The scene and minimap textures, charged to mTextures.
+	TextureHandle mSceneTextureCharge;
+	TextureHandle mMinimapCharge;
+	bool mMinimapVisible;
+	RenderStats mStats;
+	bool mStatsOverlayVisible;
+	// Start of the previous frame, 0 before the first one.
+	int mLastFrameStart;
 };
 
 
@@ -0,0 +1,78 @@
+/*
+ * ResolutionController.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "ResolutionController.h"
+
+// Weight of the newest frame in the average.
+#define SMOOTHING 0.2f
+
+ResolutionController::ResolutionController():
+	mScale(RESOLUTION_MAX_SCALE),
+	mMinScale(RESOLUTION_MIN_SCALE),
+	mMaxScale(RESOLUTION_MAX_SCALE),
+	mTarget(RESOLUTION_TARGET_FRAME_TIME),
+	mAverage(RESOLUTION_TARGET_FRAME_TIME),
+	mFramesOver(0),
+	mFramesUnder(0)
+{
+}
+
+void ResolutionController::setBounds(float minScale, float maxScale)
+{
+	mMinScale = minScale;
+	mMaxScale = (maxScale > minScale) ? maxScale : minScale;
+	mScale = clamp(mScale);
+}
+
+void ResolutionController::setTargetFrameTime(int milliseconds)
+{
+	mTarget = milliseconds;
+}
+
+float ResolutionController::clamp(float scale) const
+{
+	return (scale < mMinScale) ? mMinScale : ((scale > mMaxScale) ? mMaxScale : scale);
+}
+
+bool ResolutionController::update(int frameTime)
+{
+	mAverage += (frameTime - mAverage) * SMOOTHING;
+
+	if(mAverage > mTarget * (1.0f + RESOLUTION_DEADBAND))
+	{
+		mFramesOver++;
+		mFramesUnder = 0;
+	}
+	else if(mAverage < mTarget * (1.0f - RESOLUTION_DEADBAND))
+	{
+		mFramesUnder++;
+		mFramesOver = 0;
+	}
+	else
+	{
+		mFramesOver = 0;
+		mFramesUnder = 0;
+	}
+
+	float scale = mScale;
+	if(mFramesOver >= RESOLUTION_FRAMES_DOWN)
+	{
+		scale = clamp(mScale - RESOLUTION_SCALE_STEP);
+		mFramesOver = 0;
+	}
+	else if(mFramesUnder >= RESOLUTION_FRAMES_UP)
+	{
+		scale = clamp(mScale + RESOLUTION_SCALE_STEP);
+		mFramesUnder = 0;
+	}
+
+	if(scale == mScale)
+	{
+		return false;
+	}
+	mScale = scale;
+	return true;
+}
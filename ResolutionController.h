@@ -0,0 +1,70 @@
+/*
+ * ResolutionController.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef RESOLUTIONCONTROLLER_H_
+#define RESOLUTIONCONTROLLER_H_
+
+// Frame time to hold, in milliseconds.
+#define RESOLUTION_TARGET_FRAME_TIME 16
+// Default range of the render scale, and how far it moves at a time.
+#define RESOLUTION_MIN_SCALE 0.5f
+#define RESOLUTION_MAX_SCALE 1.0f
+#define RESOLUTION_SCALE_STEP 0.1f
+// Frame time is only acted on outside target +- this fraction.
+#define RESOLUTION_DEADBAND 0.15f
+// Consecutive frames outside the band before the scale is
+// lowered, and before it is raised again.
+#define RESOLUTION_FRAMES_DOWN 10
+#define RESOLUTION_FRAMES_UP 60
+
+/**
+ * Picks the fraction of the view's resolution to render at
+ * from measured frame times.
+ *
+ * Frame times are smoothed, and the scale only moves once they
+ * have stayed out of a band around the target for a number of
+ * frames. Going down reacts faster than going up, so a frame
+ * rate that just recovered isn't lost again right away.
+ */
+class ResolutionController
+{
+public:
+	ResolutionController();
+
+	/**
+	 * The scale stays within [minScale, maxScale].
+	 */
+	void setBounds(float minScale, float maxScale);
+
+	void setTargetFrameTime(int milliseconds);
+
+	/**
+	 * Feed the time of the last frame, in milliseconds.
+	 * @return true if the scale changed.
+	 */
+	bool update(int frameTime);
+
+	float getScale() const { return mScale; }
+
+	/**
+	 * Smoothed frame time, in milliseconds.
+	 */
+	float getAverageFrameTime() const { return mAverage; }
+
+private:
+	float clamp(float scale) const;
+
+	float mScale;
+	float mMinScale;
+	float mMaxScale;
+	int mTarget;
+	float mAverage;
+	// Frames in a row above or below the band.
+	int mFramesOver;
+	int mFramesUnder;
+};
+
+#endif /* RESOLUTIONCONTROLLER_H_ */
@@ -0,0 +1,131 @@
+/*
+ * Telemetry.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include <mavsprintf.h>
+#include <conprint.h>
+#include "Telemetry.h"
+
+TelemetryLogger::TelemetryLogger():
+	mHead(0),
+	mTail(0),
+	mDropped(0),
+	mBytesWritten(0),
+	mFile(-1)
+{
+	memset(&mPrevious, 0, sizeof(telemetryRecord));
+}
+
+TelemetryLogger::~TelemetryLogger()
+{
+	stop();
+}
+
+bool TelemetryLogger::start(const String &path)
+{
+	stop();
+	mFile = maFileOpen(path.c_str(), MA_ACCESS_READ_WRITE);
+	if(mFile < 0)
+	{
+		lprintfln("Telemetry: could not open %s (%d)", path.c_str(), mFile);
+		return false;
+	}
+	if(maFileExists(mFile))
+	{
+		maFileTruncate(mFile, 0);
+	}
+	else if(maFileCreate(mFile) < 0)
+	{
+		lprintfln("Telemetry: could not create %s", path.c_str());
+		maFileClose(mFile);
+		mFile = -1;
+		return false;
+	}
+
+	int header[3];
+	header[0] = TELEMETRY_MAGIC;
+	header[1] = TELEMETRY_VERSION;
+	header[2] = sizeof(telemetryRecord);
+	maFileWrite(mFile, header, sizeof(header));
+	mBytesWritten = sizeof(header);
+
+	memset(&mPrevious, 0, sizeof(telemetryRecord));
+	mTail = mHead;
+	Environment::getEnvironment().addTimer(this, TELEMETRY_FLUSH_PERIOD, 0);
+	return true;
+}
+
+void TelemetryLogger::stop()
+{
+	if(mFile < 0)
+	{
+		return;
+	}
+	Environment::getEnvironment().removeTimer(this);
+	flush();
+	maFileClose(mFile);
+	mFile = -1;
+}
+
+void TelemetryLogger::runTimerEvent()
+{
+	flush();
+}
+
+void TelemetryLogger::flush()
+{
+	if(mFile < 0)
+	{
+		return;
+	}
+	// Only the records that were published when we started
+	// are consumed, anything recorded meanwhile waits for the
+	// next flush.
+	int head = mHead;
+	int tail = mTail;
+	int size = 0;
+	while(tail != head)
+	{
+		size += encode(&mRing[tail & TELEMETRY_RING_MASK], mOutBuffer + size);
+		tail++;
+	}
+	mTail = tail;
+	if(size > 0)
+	{
+		maFileWrite(mFile, mOutBuffer, size);
+		mBytesWritten += size;
+	}
+}
+
+/**
+ * XOR the record against the previous one and write a mask
+ * of the non zero bytes followed by the bytes themselves.
+ * Slowly changing values leave most of the bytes zero.
+ */
+int TelemetryLogger::encode(const telemetryRecord *r, char *out)
+{
+	const int *current = (const int *)r;
+	int *previous = (int *)&mPrevious;
+	unsigned char *mask = (unsigned char *)out;
+	unsigned char *data = mask + TELEMETRY_MASK_BYTES;
+	int byte = 0;
+
+	memset(mask, 0, TELEMETRY_MASK_BYTES);
+	for(unsigned int i = 0; i < TELEMETRY_RECORD_WORDS; i++)
+	{
+		unsigned int delta = current[i] ^ previous[i];
+		previous[i] = current[i];
+		for(int b = 0; b < 4; b++, byte++)
+		{
+			unsigned char value = (delta >> (b * 8)) & 0xFF;
+			if(value != 0)
+			{
+				mask[byte >> 3] |= 1 << (byte & 7);
+				*data++ = value;
+			}
+		}
+	}
+	return (char *)data - out;
+}
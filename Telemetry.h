@@ -0,0 +1,138 @@
+/*
+ * Telemetry.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <ma.h>
+#include <MAUtil/Environment.h>
+#include <MAUtil/String.h>
+#include "Renderer.h"
+
+using namespace MAUtil;
+
+// How often the flusher drains the ring to the file, and how
+// often the simulation records, TIMER_PERIOD in main.cpp.
+#define TELEMETRY_FLUSH_PERIOD 500
+#define TELEMETRY_RECORD_PERIOD 10
+
+// Number of records the ring can hold, must be a power of two.
+// Sized for four flush periods of records, 200 at 100 Hz, so a
+// late flush drops nothing. The output buffer holds a full ring.
+#define TELEMETRY_RING_SIZE 256
+#define TELEMETRY_RING_MASK (TELEMETRY_RING_SIZE - 1)
+
+#define TELEMETRY_MAGIC 0x4C544C4D // "MLTL"
+#define TELEMETRY_VERSION 1
+
+// One fixed layout sample of the lander state.
+// Every field is 32 bits wide so the record can be
+// delta encoded a word at a time.
+struct telemetryRecord{
+	int time;
+	vector position;
+	vector velocity;
+	vector facing;
+	float altitude;
+	float frameTime;
+	int engineState;
+};
+
+#define TELEMETRY_RECORD_WORDS (sizeof(telemetryRecord) / sizeof(int))
+#define TELEMETRY_MASK_BYTES ((sizeof(telemetryRecord) + 7) / 8)
+
+/**
+ * Records telemetry samples into a preallocated ring and
+ * periodically flushes them, compressed, to a file.
+ *
+ * record() only copies the sample into the ring and never
+ * blocks: if the flusher falls behind the sample is dropped
+ * and counted. The ring has a single producer (the simulation)
+ * and a single consumer (the flusher), each owning one index,
+ * so no lock is needed.
+ *
+ * The file starts with a small header followed by the records,
+ * each one XORed against the previous record and stored as a
+ * bitmask of the non zero bytes followed by those bytes.
+ */
+class TelemetryLogger : public TimerListener
+{
+public:
+	TelemetryLogger();
+
+	virtual ~TelemetryLogger();
+
+	/**
+	 * Open (and truncate) the telemetry file and start the flusher.
+	 * @return true if the file could be opened.
+	 */
+	bool start(const String &path);
+
+	/**
+	 * Flush what is left in the ring, stop the flusher and
+	 * close the file.
+	 */
+	void stop();
+
+	/**
+	 * Store one sample. Cheap enough to call on every sim step.
+	 */
+	inline void record(
+		int time,
+		const vector &position,
+		const vector &velocity,
+		const vector &facing,
+		float altitude,
+		float frameTime,
+		bool enginesRunning)
+	{
+		int head = mHead;
+		if(head - mTail >= TELEMETRY_RING_SIZE)
+		{
+			mDropped++;
+			return;
+		}
+		telemetryRecord *r = &mRing[head & TELEMETRY_RING_MASK];
+		r->time = time;
+		r->position = position;
+		r->velocity = velocity;
+		r->facing = facing;
+		r->altitude = altitude;
+		r->frameTime = frameTime;
+		r->engineState = enginesRunning ? 1 : 0;
+		// Publish the record only after it has been written.
+		mHead = head + 1;
+	}
+
+	/**
+	 * Drain the ring into the file.
+	 */
+	void flush();
+
+	void runTimerEvent();
+
+	int getRecorded() const { return mHead; }
+
+	int getDropped() const { return mDropped; }
+
+	int getBytesWritten() const { return mBytesWritten; }
+
+private:
+	int encode(const telemetryRecord *r, char *out);
+
+	telemetryRecord mRing[TELEMETRY_RING_SIZE];
+	telemetryRecord mPrevious;
+	volatile int mHead;
+	volatile int mTail;
+	int mDropped;
+	int mBytesWritten;
+	MAHandle mFile;
+
+	// Worst case is every byte of every record being non zero.
+	char mOutBuffer[TELEMETRY_RING_SIZE * (sizeof(telemetryRecord) + TELEMETRY_MASK_BYTES)];
+};
+
+#endif /* TELEMETRY_H_ */
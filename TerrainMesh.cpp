@@ -0,0 +1,1001 @@
+/*
+ * TerrainMesh.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include <ma.h>
+#include <mastdlib.h>
+#include <conprint.h>
+#include "TerrainMesh.h"
+#include "Renderer.h"
+#include "Frustum.h"
+#include "HorizonCuller.h"
+#include "GLStateCache.h"
+#include "Matrix.h"
+#include "VertexCache.h"
+#include "MemoryTracker.h"
+
+// Offset into a bound buffer object, passed where GL expects a pointer.
+#define BUFFER_OFFSET(offset) ((const GLvoid *)(offset))
+
+// Grid spacing of each level, in segments. They
+// must divide TERRAIN_CHUNK_SEGMENTS.
+const int TerrainMesh::sLevelSteps[TERRAIN_LOD_LEVELS] = {1, 2, 5, 10};
+
+TerrainMesh::TerrainMesh():
+	mRequestedFormat(TERRAIN_VERTEX_SHORT),
+	mFormat(TERRAIN_VERTEX_FLOAT),
+	mVertices(NULL),
+	mShortVertices(NULL),
+	mTexcoordStep(1.0f),
+	mIndices(NULL),
+	mColors(NULL),
+	mNumColors(0),
+	mColorOffset(0),
+	mNumVertices(0),
+	mNumIndices(0),
+	mChunks(NULL),
+	mDrawOrder(NULL),
+	mNumChunks(0),
+	mChunksPerSide(0),
+	mLowestTop(0.0f),
+	mLandscape(NULL),
+	mAmbient(TERRAIN_AMBIENT),
+	mLightingBegin(0),
+	mLightingEnd(0),
+	mPrimitive(GL_TRIANGLE_STRIP),
+	mStripMissRatio(0.0f),
+	mMissRatio(0.0f),
+	mDrawnChunks(0),
+	mCulledChunks(0),
+	mOccludedChunks(0),
+	mUseBuffers(false),
+	mVertexBuffer(0),
+	mIndexBuffer(0)
+{
+	// High and to the side, so slopes show.
+	float sun[3] = {0.4f, 0.3f, 0.9f};
+	setLighting(sun, TERRAIN_AMBIENT);
+}
+
+TerrainMesh::~TerrainMesh()
+{
+	release();
+	delete[] mColors;
+}
+
+/**
+ * Buffer objects are core in OpenGL ES 1.1 but
+ * not available in 1.0.
+ */
+bool TerrainMesh::supportsBufferObjects()
+{
+	const char *version = (const char *)glGetString(GL_VERSION);
+	if(version == NULL)
+	{
+		return false;
+	}
+	return strstr(version, " 1.0") == NULL;
+}
+
+void TerrainMesh::build(landscape *ls)
+{
+	MemoryTagScope scope(MEMTAG_TERRAIN);
+	release();
+
+	int side = ls->segmentsPerSide;
+	mChunksPerSide = (side + TERRAIN_CHUNK_SEGMENTS - 1) / TERRAIN_CHUNK_SEGMENTS;
+	mNumChunks = mChunksPerSide * mChunksPerSide;
+
+	// Every chunk has its own full grid of shared vertices, one
+	// more than its segments on each side. Grids past the edge of
+	// the landscape repeat the edge vertices.
+	if(mNumChunks * TERRAIN_CHUNK_VERTICES > 65536)
+	{
+		maPanic(0, "TerrainMesh: too many vertices for 16 bit indices");
+	}
+	mNumVertices = mNumChunks * TERRAIN_CHUNK_VERTICES;
+	mVertices = new terrainVertex[mNumVertices];
+	mChunks = new terrainChunk[mNumChunks];
+	mDrawOrder = new int[mNumChunks];
+	for(int i = 0; i < mNumChunks; i++)
+	{
+		mDrawOrder[i] = i;
+	}
+
+	int v = 0;
+	terrainChunk *chunk = mChunks;
+	for(int cx = 0; cx < side; cx += TERRAIN_CHUNK_SEGMENTS)
+	{
+		for(int cy = 0; cy < side; cy += TERRAIN_CHUNK_SEGMENTS)
+		{
+			chunk->firstVertex = v;
+			for(int x = cx; x <= cx + TERRAIN_CHUNK_SEGMENTS; x++)
+			{
+				for(int y = cy; y <= cy + TERRAIN_CHUNK_SEGMENTS; y++)
+				{
+					addGridVertex(ls, x, y, v, (y > cy) ? v - 1 :
+						(x > cx) ? v - TERRAIN_CHUNK_SEGMENTS - 1 : -1);
+					v++;
+				}
+			}
+
+			for(int i = 0; i < 3; i++)
+			{
+				chunk->min[i] = chunk->max[i] = mVertices[chunk->firstVertex].position[i];
+			}
+			for(int j = chunk->firstVertex + 1; j < v; j++)
+			{
+				for(int i = 0; i < 3; i++)
+				{
+					float value = mVertices[j].position[i];
+					if(value < chunk->min[i]) chunk->min[i] = value;
+					if(value > chunk->max[i]) chunk->max[i] = value;
+				}
+			}
+			for(int level = 0; level < TERRAIN_LOD_LEVELS; level++)
+			{
+				chunk->error[level] = levelError(chunk, level);
+			}
+			buildOccluderCells(chunk);
+			chunk->level = 0;
+			chunk++;
+		}
+	}
+
+	// Colours from an earlier build of the same landscape
+	// are still good, except where it changed since.
+	if(ls != mLandscape || mNumColors != mNumVertices)
+	{
+		delete[] mColors;
+		mColors = new GLubyte[mNumVertices * 4];
+		mNumColors = mNumVertices;
+		mLandscape = ls;
+		invalidateLighting(0, ls->numSegments);
+	}
+	updateLighting();
+
+	mLowestTop = mChunks[0].max[2];
+	for(int i = 1; i < mNumChunks; i++)
+	{
+		mLowestTop = (mChunks[i].max[2] < mLowestTop) ? mChunks[i].max[2] : mLowestTop;
+	}
+
+	buildLevels();
+
+	mFormat = TERRAIN_VERTEX_FLOAT;
+	if(mRequestedFormat == TERRAIN_VERTEX_SHORT)
+	{
+		quantize();
+	}
+
+	upload();
+}
+
+/**
+ * The lowest height in each occluder cell of the chunk, from
+ * its grid of float vertices.
+ */
+void TerrainMesh::buildOccluderCells(terrainChunk *chunk)
+{
+	const int row = TERRAIN_CHUNK_SEGMENTS + 1;
+	const int cellSegments = TERRAIN_CHUNK_SEGMENTS / TERRAIN_OCCLUDER_CELLS;
+	const terrainVertex *grid = &mVertices[chunk->firstVertex];
+	chunk->spacing[0] = grid[row].position[0] - grid[0].position[0];
+	chunk->spacing[1] = grid[1].position[1] - grid[0].position[1];
+
+	for(int a = 0; a < TERRAIN_OCCLUDER_CELLS; a++)
+	{
+		for(int b = 0; b < TERRAIN_OCCLUDER_CELLS; b++)
+		{
+			float lowest = chunk->max[2];
+			for(int x = a * cellSegments; x <= (a + 1) * cellSegments; x++)
+			{
+				for(int y = b * cellSegments; y <= (b + 1) * cellSegments; y++)
+				{
+					float height = grid[x * row + y].position[2];
+					lowest = (height < lowest) ? height : lowest;
+				}
+			}
+			chunk->cellMin[a * TERRAIN_OCCLUDER_CELLS + b] = lowest;
+		}
+	}
+}
+
+/**
+ * Make the short vertices from the float ones, which are freed,
+ * if the texture coordinates allow it.
+ */
+void TerrainMesh::quantize()
+{
+	// Texture coordinates of a grid step apart differ by the
+	// landscape's step; all of them must be a byte of steps.
+	float step = fabs(mVertices[1].texcoord[1] - mVertices[0].texcoord[1]);
+	if(step <= 0.0f)
+	{
+		return;
+	}
+	float stepsPerUnit = (float)(int)(1.0f / step + 0.5f);
+	for(int v = 0; v < mNumVertices; v++)
+	{
+		for(int i = 0; i < 2; i++)
+		{
+			float steps = mVertices[v].texcoord[i] * stepsPerUnit;
+			float rounded = floor(steps + 0.5f);
+			if(fabs(steps - rounded) > 0.001f || rounded < -128.0f || rounded > 127.0f)
+			{
+				lprintfln("TerrainMesh: texture coordinates don't fit bytes, using float vertices");
+				return;
+			}
+		}
+	}
+	mTexcoordStep = 1.0f / stepsPerUnit;
+
+	mShortVertices = new terrainShortVertex[mNumVertices];
+	for(int c = 0; c < mNumChunks; c++)
+	{
+		terrainChunk *chunk = &mChunks[c];
+		for(int i = 0; i < 3; i++)
+		{
+			float extent = chunk->max[i] - chunk->min[i];
+			chunk->origin[i] = (chunk->min[i] + chunk->max[i]) * 0.5f;
+			chunk->scale[i] = (extent > 0.0f) ? extent / 65534.0f : 1.0f;
+		}
+		for(int v = chunk->firstVertex; v < chunk->firstVertex + TERRAIN_CHUNK_VERTICES; v++)
+		{
+			for(int i = 0; i < 3; i++)
+			{
+				float q = (mVertices[v].position[i] - chunk->origin[i]) / chunk->scale[i];
+				mShortVertices[v].position[i] = (GLshort)floor(q + 0.5f);
+			}
+			for(int i = 0; i < 2; i++)
+			{
+				mShortVertices[v].texcoord[i] = (GLbyte)floor(mVertices[v].texcoord[i] * stepsPerUnit + 0.5f);
+			}
+		}
+	}
+
+	delete[] mVertices;
+	mVertices = NULL;
+	mFormat = TERRAIN_VERTEX_SHORT;
+}
+
+/**
+ * Build the index sets for every level and combination of
+ * coarser neighbours. They index a chunk's own grid, so one
+ * set of them serves all chunks.
+ */
+void TerrainMesh::buildLevels()
+{
+	int size = 0;
+	for(int level = 0; level < TERRAIN_LOD_LEVELS; level++)
+	{
+		int cells = TERRAIN_CHUNK_SEGMENTS / sLevelSteps[level];
+		size += (cells * (cells + 1) * 2 + (cells - 1) * 2) * TERRAIN_LOD_MASKS;
+	}
+	mIndices = new GLushort[size];
+
+	int n = 0;
+	for(int level = 0; level < TERRAIN_LOD_LEVELS; level++)
+	{
+		for(int mask = 0; mask < TERRAIN_LOD_MASKS; mask++)
+		{
+			terrainLevelSet *set = &mLevelSets[level][mask];
+			set->firstIndex = n;
+			n = addLevelStrip(level, mask, n);
+			set->numIndices = n - set->firstIndex;
+		}
+	}
+	mNumIndices = n;
+	mPrimitive = GL_TRIANGLE_STRIP;
+
+	optimizeLevels();
+
+	for(int level = 0; level < TERRAIN_LOD_LEVELS; level++)
+	{
+		for(int mask = 0; mask < TERRAIN_LOD_MASKS; mask++)
+		{
+			// Grid points the set uses, for the statistics.
+			terrainLevelSet *set = &mLevelSets[level][mask];
+			bool used[TERRAIN_CHUNK_VERTICES];
+			memset(used, 0, sizeof(used));
+			set->numVertices = 0;
+			for(int j = set->firstIndex; j < set->firstIndex + set->numIndices; j++)
+			{
+				if(!used[mIndices[j]])
+				{
+					used[mIndices[j]] = true;
+					set->numVertices++;
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Turn the strips into triangle lists ordered for the vertex
+ * cache. A list takes about three times the indices, which is
+ * little next to the vertices since the sets are shared, so the
+ * lists are kept whenever they transform fewer vertices.
+ */
+void TerrainMesh::optimizeLevels()
+{
+	GLushort *lists = new GLushort[mNumIndices * 3];
+	terrainLevelSet listSets[TERRAIN_LOD_LEVELS][TERRAIN_LOD_MASKS];
+	int stripMisses = 0;
+	int listMisses = 0;
+	int triangles = 0;
+	int n = 0;
+	for(int level = 0; level < TERRAIN_LOD_LEVELS; level++)
+	{
+		for(int mask = 0; mask < TERRAIN_LOD_MASKS; mask++)
+		{
+			const terrainLevelSet *strip = &mLevelSets[level][mask];
+			const GLushort *indices = mIndices + strip->firstIndex;
+			int stripTriangles;
+			stripMisses += VertexCache::stripMisses(indices, strip->numIndices, &stripTriangles);
+			triangles += stripTriangles;
+
+			terrainLevelSet *list = &listSets[level][mask];
+			list->firstIndex = n;
+			list->numIndices = VertexCache::stripToTriangles(indices, strip->numIndices, lists + n);
+			VertexCache::optimize(lists + n, list->numIndices, TERRAIN_CHUNK_VERTICES);
+			listMisses += VertexCache::triangleMisses(lists + n, list->numIndices);
+			n += list->numIndices;
+		}
+	}
+
+	mStripMissRatio = (float)stripMisses / triangles;
+	if(listMisses < stripMisses)
+	{
+		delete[] mIndices;
+		mIndices = new GLushort[n];
+		memcpy(mIndices, lists, n * sizeof(GLushort));
+		mNumIndices = n;
+		memcpy(mLevelSets, listSets, sizeof(mLevelSets));
+		mPrimitive = GL_TRIANGLES;
+		mMissRatio = (float)listMisses / triangles;
+	}
+	else
+	{
+		mMissRatio = mStripMissRatio;
+	}
+	delete[] lists;
+	lprintfln("TerrainMesh: vertex cache miss ratio %.3f as strips, %.3f as drawn",
+		mStripMissRatio, mMissRatio);
+}
+
+/**
+ * Nearest multiple of step, rounding ties down.
+ */
+static int snap(int value, int step)
+{
+	return ((2 * value + step - 1) / (2 * step)) * step;
+}
+
+/**
+ * Index of grid point (x, y) in a chunk at the given level.
+ * On an edge shared with a coarser chunk the point is moved
+ * to the nearest of the coarser level's points, so both sides
+ * of the edge have the same straight segments and no cracks.
+ */
+static int gridIndex(int x, int y, int mask, int coarseStep)
+{
+	if((x == 0 && (mask & TERRAIN_LOD_COARSER_LEFT)) ||
+		(x == TERRAIN_CHUNK_SEGMENTS && (mask & TERRAIN_LOD_COARSER_RIGHT)))
+	{
+		y = snap(y, coarseStep);
+	}
+	if((y == 0 && (mask & TERRAIN_LOD_COARSER_BOTTOM)) ||
+		(y == TERRAIN_CHUNK_SEGMENTS && (mask & TERRAIN_LOD_COARSER_TOP)))
+	{
+		x = snap(x, coarseStep);
+	}
+	return x * (TERRAIN_CHUNK_SEGMENTS + 1) + y;
+}
+
+int TerrainMesh::addLevelStrip(int level, int mask, int n)
+{
+	int step = sLevelSteps[level];
+	int coarseStep = sLevelSteps[(level + 1 < TERRAIN_LOD_LEVELS) ? level + 1 : level];
+	for(int x = 0; x < TERRAIN_CHUNK_SEGMENTS; x += step)
+	{
+		if(x > 0)
+		{
+			// Stitch to the previous row.
+			mIndices[n] = mIndices[n - 1];
+			mIndices[n + 1] = gridIndex(x, 0, mask, coarseStep);
+			n += 2;
+		}
+		for(int y = 0; y <= TERRAIN_CHUNK_SEGMENTS; y += step)
+		{
+			mIndices[n++] = gridIndex(x, y, mask, coarseStep);
+			mIndices[n++] = gridIndex(x + step, y, mask, coarseStep);
+		}
+	}
+	return n;
+}
+
+/**
+ * The largest vertical distance between the full resolution
+ * grid and the surface of the given level.
+ */
+float TerrainMesh::levelError(const terrainChunk *chunk, int level)
+{
+	int step = sLevelSteps[level];
+	const terrainVertex *grid = &mVertices[chunk->firstVertex];
+	float error = 0.0f;
+	for(int x = 0; x <= TERRAIN_CHUNK_SEGMENTS; x++)
+	{
+		int x0 = (x == TERRAIN_CHUNK_SEGMENTS) ? x - step : (x / step) * step;
+		float fx = (float)(x - x0) / step;
+		for(int y = 0; y <= TERRAIN_CHUNK_SEGMENTS; y++)
+		{
+			int y0 = (y == TERRAIN_CHUNK_SEGMENTS) ? y - step : (y / step) * step;
+			float fy = (float)(y - y0) / step;
+			// Bilinear within the level's cell.
+			float h00 = grid[x0 * (TERRAIN_CHUNK_SEGMENTS + 1) + y0].position[2];
+			float h10 = grid[(x0 + step) * (TERRAIN_CHUNK_SEGMENTS + 1) + y0].position[2];
+			float h01 = grid[x0 * (TERRAIN_CHUNK_SEGMENTS + 1) + y0 + step].position[2];
+			float h11 = grid[(x0 + step) * (TERRAIN_CHUNK_SEGMENTS + 1) + y0 + step].position[2];
+			float h = (h00 * (1 - fx) + h10 * fx) * (1 - fy) + (h01 * (1 - fx) + h11 * fx) * fy;
+			float d = fabs(grid[x * (TERRAIN_CHUNK_SEGMENTS + 1) + y].position[2] - h);
+			if(d > error)
+			{
+				error = d;
+			}
+		}
+	}
+	return error;
+}
+
+/**
+ * Fill vertex v with grid point (x, y), the lower left corner of
+ * segment (x, y), or a corner of a neighbour on the far edges.
+ *
+ * The landscape wraps texture coordinates back to 0 at every
+ * texture repeat, which a vertex shared by both sides can't do.
+ * They are made continuous by unwrapping against the previous
+ * vertex and left to GL_REPEAT.
+ */
+void TerrainMesh::addGridVertex(landscape *ls, int x, int y, int v, int previous)
+{
+	int side = ls->segmentsPerSide;
+	int sx = (x < side) ? x : side - 1;
+	int sy = (y < side) ? y : side - 1;
+	// Corners are 0 (-x, -y), 1 (+x, -y), 2 (+x, +y) and 3 (-x, +y).
+	static const int corners[2][2] = {{0, 3}, {1, 2}};
+	int corner = corners[x != sx][y != sy];
+	landSegment *segment = &ls->segments[sx * side + sy];
+
+	terrainVertex *vertex = &mVertices[v];
+	memcpy(vertex->position, segment->vcoords[corner], sizeof(GLfloat) * 3);
+	memcpy(vertex->texcoord, segment->tcoords[corner], sizeof(GLfloat) * 2);
+	if(previous >= 0)
+	{
+		for(int i = 0; i < 2; i++)
+		{
+			float delta = mVertices[previous].texcoord[i] - vertex->texcoord[i];
+			vertex->texcoord[i] += (float)(int)(delta + (delta > 0 ? 0.5f : -0.5f));
+		}
+	}
+}
+
+void TerrainMesh::upload()
+{
+	mUseBuffers = supportsBufferObjects();
+	if(!mUseBuffers)
+	{
+		lprintfln("TerrainMesh: no buffer objects, drawing from client memory");
+		return;
+	}
+
+	glGenBuffers(1, &mVertexBuffer);
+	glGenBuffers(1, &mIndexBuffer);
+
+	// The colours follow the vertices in the same buffer.
+	glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
+	if(mFormat == TERRAIN_VERTEX_SHORT)
+	{
+		mColorOffset = mNumVertices * sizeof(terrainShortVertex);
+		glBufferData(GL_ARRAY_BUFFER, mColorOffset + mNumVertices * 4, NULL, GL_STATIC_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, mColorOffset, mShortVertices);
+	}
+	else
+	{
+		mColorOffset = mNumVertices * sizeof(terrainVertex);
+		glBufferData(GL_ARRAY_BUFFER, mColorOffset + mNumVertices * 4, NULL, GL_STATIC_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, mColorOffset, mVertices);
+	}
+	glBufferSubData(GL_ARRAY_BUFFER, mColorOffset, mNumVertices * 4, mColors);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, mNumIndices * sizeof(GLushort), mIndices, GL_STATIC_DRAW);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	if(glGetError() != GL_NO_ERROR)
+	{
+		lprintfln("TerrainMesh: buffer upload failed, drawing from client memory");
+		glDeleteBuffers(1, &mVertexBuffer);
+		glDeleteBuffers(1, &mIndexBuffer);
+		mVertexBuffer = 0;
+		mIndexBuffer = 0;
+		mUseBuffers = false;
+		return;
+	}
+
+	// The GL has its own copy now.
+	delete[] mVertices;
+	delete[] mShortVertices;
+	delete[] mIndices;
+	mVertices = NULL;
+	mShortVertices = NULL;
+	mIndices = NULL;
+}
+
+void TerrainMesh::release()
+{
+	if(mUseBuffers)
+	{
+		glDeleteBuffers(1, &mVertexBuffer);
+		glDeleteBuffers(1, &mIndexBuffer);
+		mVertexBuffer = 0;
+		mIndexBuffer = 0;
+		mUseBuffers = false;
+	}
+	delete[] mVertices;
+	delete[] mShortVertices;
+	delete[] mIndices;
+	delete[] mChunks;
+	delete[] mDrawOrder;
+	mVertices = NULL;
+	mShortVertices = NULL;
+	mIndices = NULL;
+	mChunks = NULL;
+	mDrawOrder = NULL;
+	mNumVertices = 0;
+	mNumIndices = 0;
+	mNumChunks = 0;
+	mChunksPerSide = 0;
+}
+
+void TerrainMesh::setLighting(const float *sunDirection, float ambient)
+{
+	float length = sqrt(sunDirection[0] * sunDirection[0] +
+		sunDirection[1] * sunDirection[1] + sunDirection[2] * sunDirection[2]);
+	for(int i = 0; i < 3; i++)
+	{
+		mSun[i] = sunDirection[i] / length;
+	}
+	mAmbient = ambient;
+	invalidateLighting(0, (mLandscape != NULL) ? mLandscape->numSegments : 0);
+}
+
+void TerrainMesh::invalidateLighting(int begin, int end)
+{
+	if(end <= begin)
+	{
+		return;
+	}
+	if(mLightingEnd <= mLightingBegin)
+	{
+		mLightingBegin = begin;
+		mLightingEnd = end;
+		return;
+	}
+	mLightingBegin = (begin < mLightingBegin) ? begin : mLightingBegin;
+	mLightingEnd = (end > mLightingEnd) ? end : mLightingEnd;
+}
+
+/**
+ * Whether any segment touching a vertex of the chunk, its own
+ * and the ring around them, is in the out of date range.
+ */
+bool TerrainMesh::isLightingDirty(int cx, int cy) const
+{
+	int side = mLandscape->segmentsPerSide;
+	int y0 = cy * TERRAIN_CHUNK_SEGMENTS - 1;
+	int y1 = cy * TERRAIN_CHUNK_SEGMENTS + TERRAIN_CHUNK_SEGMENTS;
+	y0 = (y0 > 0) ? y0 : 0;
+	y1 = (y1 < side - 1) ? y1 : side - 1;
+	for(int x = cx * TERRAIN_CHUNK_SEGMENTS - 1; x <= cx * TERRAIN_CHUNK_SEGMENTS + TERRAIN_CHUNK_SEGMENTS; x++)
+	{
+		if(x < 0 || x >= side)
+		{
+			continue;
+		}
+		if(x * side + y0 < mLightingEnd && x * side + y1 >= mLightingBegin)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Light each vertex of the chunk with the average normal of
+ * the triangles around it. Corner 1 is only in the first
+ * triangle of a segment and corner 3 only in the second.
+ */
+void TerrainMesh::lightChunk(int cx, int cy)
+{
+	static const int cornerFaces[4][2] = {{1, 1}, {1, 0}, {1, 1}, {0, 1}};
+	int side = mLandscape->segmentsPerSide;
+	GLubyte *color = &mColors[(cx * mChunksPerSide + cy) * TERRAIN_CHUNK_VERTICES * 4];
+	for(int x = cx * TERRAIN_CHUNK_SEGMENTS; x <= cx * TERRAIN_CHUNK_SEGMENTS + TERRAIN_CHUNK_SEGMENTS; x++)
+	{
+		for(int y = cy * TERRAIN_CHUNK_SEGMENTS; y <= cy * TERRAIN_CHUNK_SEGMENTS + TERRAIN_CHUNK_SEGMENTS; y++)
+		{
+			// Past the edge the grid repeats the edge vertices.
+			int gx = (x < side) ? x : side;
+			int gy = (y < side) ? y : side;
+			float normal[3] = {0.0f, 0.0f, 0.0f};
+			for(int corner = 0; corner < 4; corner++)
+			{
+				// The segment that has this grid point as the corner.
+				int sx = gx - ((corner == 1 || corner == 2) ? 1 : 0);
+				int sy = gy - ((corner >= 2) ? 1 : 0);
+				if(sx < 0 || sy < 0 || sx >= side || sy >= side)
+				{
+					continue;
+				}
+				const landSegment *segment = &mLandscape->segments[sx * side + sy];
+				for(int face = 0; face < 2; face++)
+				{
+					if(cornerFaces[corner][face])
+					{
+						normal[0] += segment->normalVector[face].x;
+						normal[1] += segment->normalVector[face].y;
+						normal[2] += segment->normalVector[face].z;
+					}
+				}
+			}
+
+			float length = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			float diffuse = (length > 0.0f) ?
+				(normal[0] * mSun[0] + normal[1] * mSun[1] + normal[2] * mSun[2]) / length : 0.0f;
+			float light = mAmbient + (1.0f - mAmbient) * ((diffuse > 0.0f) ? diffuse : 0.0f);
+			GLubyte value = (GLubyte)(255.0f * light + 0.5f);
+			color[0] = color[1] = color[2] = value;
+			color[3] = 255;
+			color += 4;
+		}
+	}
+}
+
+/**
+ * Light the chunks that are out of date. With buffer objects
+ * the vertex buffer must be bound, runs of chunks next to
+ * each other in it are uploaded together.
+ */
+void TerrainMesh::updateLighting()
+{
+	if(mLightingEnd <= mLightingBegin || mLandscape == NULL)
+	{
+		return;
+	}
+
+	const int chunkBytes = TERRAIN_CHUNK_VERTICES * 4;
+	int runStart = -1;
+	for(int i = 0; i <= mNumChunks; i++)
+	{
+		bool dirty = i < mNumChunks &&
+			isLightingDirty(i / mChunksPerSide, i % mChunksPerSide);
+		if(dirty)
+		{
+			lightChunk(i / mChunksPerSide, i % mChunksPerSide);
+			runStart = (runStart < 0) ? i : runStart;
+		}
+		else if(runStart >= 0)
+		{
+			if(mUseBuffers)
+			{
+				glBufferSubData(GL_ARRAY_BUFFER, mColorOffset + runStart * chunkBytes,
+					(i - runStart) * chunkBytes, &mColors[runStart * chunkBytes]);
+			}
+			runStart = -1;
+		}
+	}
+	mLightingBegin = mLightingEnd = 0;
+}
+
+void TerrainMesh::selectLevels(const float *eye, float pixelsPerUnit, float maxPixelError)
+{
+	if(!isBuilt())
+	{
+		return;
+	}
+
+	// The coarsest level whose error, projected at the distance
+	// of the nearest point of the chunk, is small enough.
+	for(int i = 0; i < mNumChunks; i++)
+	{
+		terrainChunk *chunk = &mChunks[i];
+		float distance = 0.0f;
+		for(int j = 0; j < 3; j++)
+		{
+			float d = (eye[j] < chunk->min[j]) ? chunk->min[j] - eye[j] :
+				(eye[j] > chunk->max[j]) ? eye[j] - chunk->max[j] : 0.0f;
+			distance += d * d;
+		}
+		distance = sqrt(distance);
+
+		chunk->level = 0;
+		for(int level = TERRAIN_LOD_LEVELS - 1; level > 0; level--)
+		{
+			if(chunk->error[level] * pixelsPerUnit <= maxPixelError * distance)
+			{
+				chunk->level = level;
+				break;
+			}
+		}
+	}
+
+	// Stitching only handles neighbours one level apart,
+	// refine chunks until no neighbour is further off.
+	bool changed = true;
+	while(changed)
+	{
+		changed = false;
+		for(int i = 0; i < mNumChunks; i++)
+		{
+			int cx = i / mChunksPerSide;
+			int cy = i % mChunksPerSide;
+			int finest = chunkLevel(cx - 1, cy);
+			int level = chunkLevel(cx + 1, cy);
+			finest = (level < finest) ? level : finest;
+			level = chunkLevel(cx, cy - 1);
+			finest = (level < finest) ? level : finest;
+			level = chunkLevel(cx, cy + 1);
+			finest = (level < finest) ? level : finest;
+			if(mChunks[i].level > finest + 1)
+			{
+				mChunks[i].level = finest + 1;
+				changed = true;
+			}
+		}
+	}
+}
+
+void TerrainMesh::getBounds(float *min, float *max) const
+{
+	for(int j = 0; j < 3; j++)
+	{
+		min[j] = mChunks[0].min[j];
+		max[j] = mChunks[0].max[j];
+	}
+	for(int i = 1; i < mNumChunks; i++)
+	{
+		for(int j = 0; j < 3; j++)
+		{
+			min[j] = (mChunks[i].min[j] < min[j]) ? mChunks[i].min[j] : min[j];
+			max[j] = (mChunks[i].max[j] > max[j]) ? mChunks[i].max[j] : max[j];
+		}
+	}
+}
+
+/**
+ * Level of chunk (cx, cy), or the coarsest level past the edges.
+ */
+int TerrainMesh::chunkLevel(int cx, int cy) const
+{
+	if(cx < 0 || cy < 0 || cx >= mChunksPerSide || cy >= mChunksPerSide)
+	{
+		return TERRAIN_LOD_LEVELS - 1;
+	}
+	return mChunks[cx * mChunksPerSide + cy].level;
+}
+
+/**
+ * Order the chunks by distance from the eye. The order changes
+ * little between frames, so an insertion sort from the last
+ * frame's order is cheap.
+ */
+void TerrainMesh::sortFrontToBack(const HorizonCuller *horizon)
+{
+	for(int i = 0; i < mNumChunks; i++)
+	{
+		mChunks[i].distance = horizon->getDistance(mChunks[i].min, mChunks[i].max);
+	}
+	for(int i = 1; i < mNumChunks; i++)
+	{
+		int index = mDrawOrder[i];
+		float distance = mChunks[index].distance;
+		int j = i;
+		while(j > 0 && mChunks[mDrawOrder[j - 1]].distance > distance)
+		{
+			mDrawOrder[j] = mDrawOrder[j - 1];
+			j--;
+		}
+		mDrawOrder[j] = index;
+	}
+}
+
+/**
+ * A whole chunk spans valleys and hills, so its lowest point
+ * says little. Its cells, each a few segments wide, follow the
+ * ridges closely enough to hide what lies behind them.
+ */
+void TerrainMesh::addOccluders(HorizonCuller *horizon, const terrainChunk *chunk)
+{
+	if(chunk->distance > horizon->getRange())
+	{
+		return;
+	}
+
+	// A cell no higher than the eye or the top of any chunk
+	// can't hide a chunk: the chunk reaches at least as high
+	// and is further away, so it's seen above the cell.
+	float useless = horizon->getEye()[2];
+	useless = (mLowestTop < useless) ? mLowestTop : useless;
+
+	const int cellSegments = TERRAIN_CHUNK_SEGMENTS / TERRAIN_OCCLUDER_CELLS;
+	float min[3];
+	float max[3];
+	for(int a = 0; a < TERRAIN_OCCLUDER_CELLS; a++)
+	{
+		// Grids past the edge of the landscape repeat their edge
+		// vertices, cells there are cut off at the chunk's bounds.
+		min[0] = chunk->min[0] + a * cellSegments * chunk->spacing[0];
+		max[0] = min[0] + cellSegments * chunk->spacing[0];
+		max[0] = (max[0] < chunk->max[0]) ? max[0] : chunk->max[0];
+		for(int b = 0; b < TERRAIN_OCCLUDER_CELLS; b++)
+		{
+			min[1] = chunk->min[1] + b * cellSegments * chunk->spacing[1];
+			max[1] = min[1] + cellSegments * chunk->spacing[1];
+			max[1] = (max[1] < chunk->max[1]) ? max[1] : chunk->max[1];
+			if(min[0] >= max[0] || min[1] >= max[1])
+			{
+				continue;
+			}
+			min[2] = chunk->cellMin[a * TERRAIN_OCCLUDER_CELLS + b];
+			if(min[2] <= useless)
+			{
+				continue;
+			}
+			max[2] = chunk->max[2];
+			horizon->addOccluder(min, max);
+		}
+	}
+}
+
+void TerrainMesh::draw(const Frustum *frustum, HorizonCuller *horizon,
+	GLStateCache *state, const float *view)
+{
+	mDrawnChunks = 0;
+	mCulledChunks = 0;
+	mOccludedChunks = 0;
+	if(!isBuilt())
+	{
+		return;
+	}
+
+	if(mUseBuffers)
+	{
+		state->bindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
+		state->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer);
+	}
+
+	bool quantized = mFormat == TERRAIN_VERTEX_SHORT;
+	if(quantized)
+	{
+		// Texture coordinates are in grid steps.
+		state->matrixMode(GL_TEXTURE);
+		glLoadIdentity();
+		glScalef(mTexcoordStep, mTexcoordStep, 1.0f);
+		state->matrixMode(GL_MODELVIEW);
+	}
+
+	// After the sun or the landscape changed.
+	updateLighting();
+
+	if(horizon != NULL)
+	{
+		sortFrontToBack(horizon);
+	}
+
+	// Index sets are relative to a chunk's grid, so every chunk is
+	// drawn on its own with the arrays pointing at its vertices.
+	for(int n = 0; n < mNumChunks; n++)
+	{
+		int i = mDrawOrder[n];
+		terrainChunk *chunk = &mChunks[i];
+		if(frustum != NULL && !frustum->isBoxVisible(chunk->min, chunk->max))
+		{
+			// Still part of the horizon, from below the view.
+			if(horizon != NULL)
+			{
+				addOccluders(horizon, chunk);
+			}
+			mCulledChunks++;
+			continue;
+		}
+		if(horizon != NULL)
+		{
+			if(horizon->isBoxOccluded(chunk->min, chunk->max))
+			{
+				mOccludedChunks++;
+				continue;
+			}
+			addOccluders(horizon, chunk);
+		}
+		mDrawnChunks++;
+
+		int cx = i / mChunksPerSide;
+		int cy = i % mChunksPerSide;
+		int mask = 0;
+		if(chunkLevel(cx - 1, cy) > chunk->level) mask |= TERRAIN_LOD_COARSER_LEFT;
+		if(chunkLevel(cx + 1, cy) > chunk->level) mask |= TERRAIN_LOD_COARSER_RIGHT;
+		if(chunkLevel(cx, cy - 1) > chunk->level) mask |= TERRAIN_LOD_COARSER_BOTTOM;
+		if(chunkLevel(cx, cy + 1) > chunk->level) mask |= TERRAIN_LOD_COARSER_TOP;
+		terrainLevelSet *set = &mLevelSets[chunk->level][mask];
+
+		if(quantized)
+		{
+			// view * translate(origin) * scale(scale)
+			float modelview[16];
+			for(int j = 0; j < 3; j++)
+			{
+				for(int row = 0; row < 4; row++)
+				{
+					modelview[j * 4 + row] = view[j * 4 + row] * chunk->scale[j];
+				}
+			}
+			Matrix::transformPoint(&modelview[12], view,
+				chunk->origin[0], chunk->origin[1], chunk->origin[2]);
+			glLoadMatrixf(modelview);
+		}
+		setChunkArrays(chunk);
+
+		if(mUseBuffers)
+		{
+			state->drawElements(mPrimitive, set->numIndices, GL_UNSIGNED_SHORT,
+				BUFFER_OFFSET(set->firstIndex * sizeof(GLushort)), set->numVertices);
+		}
+		else
+		{
+			state->drawElements(mPrimitive, set->numIndices, GL_UNSIGNED_SHORT,
+				mIndices + set->firstIndex, set->numVertices);
+		}
+	}
+
+	if(quantized)
+	{
+		glLoadMatrixf(view);
+		state->matrixMode(GL_TEXTURE);
+		glLoadIdentity();
+		state->matrixMode(GL_MODELVIEW);
+	}
+}
+
+/**
+ * Point the vertex, texture coordinate and colour arrays at the
+ * grid of the chunk, in the buffer object or in client memory.
+ */
+void TerrainMesh::setChunkArrays(const terrainChunk *chunk)
+{
+	if(mFormat == TERRAIN_VERTEX_SHORT)
+	{
+		size_t offset = chunk->firstVertex * sizeof(terrainShortVertex);
+		const char *base = mUseBuffers ? (const char *)BUFFER_OFFSET(offset) :
+			(const char *)&mShortVertices[chunk->firstVertex];
+		glVertexPointer(3, GL_SHORT, sizeof(terrainShortVertex), base);
+		glTexCoordPointer(2, GL_BYTE, sizeof(terrainShortVertex),
+			base + sizeof(GLshort) * 3);
+	}
+	else
+	{
+		size_t offset = chunk->firstVertex * sizeof(terrainVertex);
+		const char *base = mUseBuffers ? (const char *)BUFFER_OFFSET(offset) :
+			(const char *)&mVertices[chunk->firstVertex];
+		glVertexPointer(3, GL_FLOAT, sizeof(terrainVertex), base);
+		glTexCoordPointer(2, GL_FLOAT, sizeof(terrainVertex),
+			base + sizeof(GLfloat) * 3);
+	}
+
+	size_t offset = mColorOffset + chunk->firstVertex * 4;
+	glColorPointer(4, GL_UNSIGNED_BYTE, 0, mUseBuffers ?
+		BUFFER_OFFSET(offset) : &mColors[chunk->firstVertex * 4]);
+}
@@ -0,0 +1,292 @@
+/*
+ * TerrainMesh.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef TERRAINMESH_H_
+#define TERRAINMESH_H_
+
+#include <GLES/gl.h>
+
+struct landscape;
+class Frustum;
+class GLStateCache;
+class HorizonCuller;
+
+// Side of the square blocks of segments the terrain
+// geometry is laid out in.
+#define TERRAIN_CHUNK_SEGMENTS 10
+#define TERRAIN_CHUNK_VERTICES ((TERRAIN_CHUNK_SEGMENTS + 1) * (TERRAIN_CHUNK_SEGMENTS + 1))
+
+// Detail levels of a chunk, see TerrainMesh::sLevelSteps.
+#define TERRAIN_LOD_LEVELS 4
+
+// Which neighbours of a chunk are drawn at a coarser level.
+#define TERRAIN_LOD_COARSER_LEFT 1
+#define TERRAIN_LOD_COARSER_RIGHT 2
+#define TERRAIN_LOD_COARSER_BOTTOM 4
+#define TERRAIN_LOD_COARSER_TOP 8
+#define TERRAIN_LOD_MASKS 16
+
+// Side of the square of cells a chunk adds to the horizon as,
+// they must divide TERRAIN_CHUNK_SEGMENTS.
+#define TERRAIN_OCCLUDER_CELLS 5
+
+// Light the terrain gets everywhere, the sun adds the rest.
+#define TERRAIN_AMBIENT 0.35f
+
+// Default screen space error allowed, in pixels.
+#define TERRAIN_MAX_PIXEL_ERROR 4.0f
+
+struct terrainVertex{
+	GLfloat position[3];
+	GLfloat texcoord[2];
+};
+
+// A quantized vertex, 8 bytes instead of 20. The position is
+// relative to its chunk's origin and scale, the texture
+// coordinate is in steps of the grid's texture coordinate step.
+struct terrainShortVertex{
+	GLshort position[3];
+	GLbyte texcoord[2];
+};
+
+enum TerrainVertexFormat
+{
+	TERRAIN_VERTEX_FLOAT,
+	TERRAIN_VERTEX_SHORT
+};
+
+// A block of segments with its bounding box, its grid
+// of vertices and the height error of each level.
+struct terrainChunk{
+	float min[3];
+	float max[3];
+	// Maps quantized positions back to the landscape.
+	float origin[3];
+	float scale[3];
+	int firstVertex;
+	float error[TERRAIN_LOD_LEVELS];
+	int level;
+	// From the eye, for drawing front to back.
+	float distance;
+	// Size of a segment, and the lowest point of each occluder
+	// cell. Cells run along y first, like the segments.
+	float spacing[2];
+	float cellMin[TERRAIN_OCCLUDER_CELLS * TERRAIN_OCCLUDER_CELLS];
+};
+
+// The triangles of one level and neighbour combination
+// in the index buffer.
+struct terrainLevelSet{
+	int firstIndex;
+	int numIndices;
+	// Distinct grid points among the indices.
+	int numVertices;
+};
+
+/**
+ * The landscape geometry, drawn with geometrical mipmapping.
+ *
+ * The terrain is split into chunks, each with a grid of shared
+ * vertices. A chunk is drawn in a single call at one
+ * of TERRAIN_LOD_LEVELS levels of detail, which skip 1, 2, 5
+ * or 10 grid points. The level is the coarsest one whose height
+ * error, projected to the screen, stays within a pixel limit.
+ *
+ * Neighbouring chunks differ by at most one level. Along an
+ * edge shared with a coarser chunk, the finer chunk uses the
+ * coarser chunk's vertices, so the edges meet without cracks.
+ * The index sets use a chunk's own grid, so the sets for all
+ * levels and neighbour combinations are shared by all chunks.
+ * They are built as strips and then reordered as triangle
+ * lists for the post-transform vertex cache, unless that
+ * misses the cache more often.
+ *
+ * Vertices are quantized to shorts and bytes by default. Each
+ * chunk's positions span the full short range, and the chunk's
+ * scale and offset are folded into the modelview matrix it is
+ * drawn with. Texture coordinates count grid steps, undone by
+ * the texture matrix.
+ *
+ * Lighting is baked into a colour per vertex, from the
+ * landscape's face normals, a sun direction and an ambient term.
+ * The colours outlive rebuilds of the geometry, and only the
+ * chunks around changed segments, or all of them when the sun
+ * moves, are lit again.
+ *
+ * When the GL supports buffer objects the vertices and indices
+ * are uploaded once into a VBO and an IBO, otherwise they are
+ * drawn from client memory. Chunks outside the view frustum
+ * are culled. With a horizon culler chunks are drawn front to
+ * back, and those hidden behind nearer terrain are skipped.
+ */
+class TerrainMesh
+{
+public:
+	TerrainMesh();
+
+	~TerrainMesh();
+
+	/**
+	 * Build the vertex and index data for the landscape and
+	 * upload it. Needs a current GL context.
+	 */
+	void build(landscape *ls);
+
+	/**
+	 * Free the geometry and the GL buffers.
+	 */
+	void release();
+
+	/**
+	 * Vertex format of the next build, TERRAIN_VERTEX_SHORT by
+	 * default. Float vertices are used anyway if the texture
+	 * coordinates are not on a grid a byte can hold.
+	 */
+	void setVertexFormat(TerrainVertexFormat format) { mRequestedFormat = format; }
+
+	TerrainVertexFormat getVertexFormat() const { return mFormat; }
+
+	/**
+	 * Direction towards the sun and the ambient light, from 0 to 1.
+	 * All chunks are lit again on the next draw.
+	 */
+	void setLighting(const float *sunDirection, float ambient);
+
+	/**
+	 * Normals of landscape segments [begin, end) changed. The
+	 * chunks around them are lit again on the next build or draw.
+	 */
+	void invalidateLighting(int begin, int end);
+
+	/**
+	 * Pick the level of detail of every chunk for a viewer at eye.
+	 * pixelsPerUnit is the size in pixels of one unit at distance
+	 * one, viewport height / (2 * tan(fovy / 2)).
+	 */
+	void selectLevels(const float *eye, float pixelsPerUnit, float maxPixelError);
+
+	/**
+	 * Draw the chunks of the terrain that are inside the frustum,
+	 * or all of them when frustum is NULL. With a horizon, which
+	 * must have been started from the eye, chunks are drawn front
+	 * to back and occluded ones are skipped. Vertex, colour and
+	 * texture coordinate arrays must be enabled by the caller. Buffer
+	 * objects are bound through the state cache and left bound.
+	 * view is the modelview matrix, which is loaded again after
+	 * drawing quantized chunks.
+	 */
+	void draw(const Frustum *frustum, HorizonCuller *horizon,
+		GLStateCache *state, const float *view);
+
+	bool isBuilt() const { return mNumIndices > 0; }
+
+	int getNumChunks() const { return mNumChunks; }
+
+	/**
+	 * Box around the whole terrain, once built.
+	 */
+	void getBounds(float *min, float *max) const;
+
+	int getDrawnChunks() const { return mDrawnChunks; }
+
+	int getCulledChunks() const { return mCulledChunks; }
+
+	/**
+	 * Chunks inside the frustum skipped behind the horizon
+	 * in the last draw.
+	 */
+	int getOccludedChunks() const { return mOccludedChunks; }
+
+	bool usesBufferObjects() const { return mUseBuffers; }
+
+	/**
+	 * Average cache miss ratio of the index sets, vertices
+	 * transformed per triangle, as strips and as drawn.
+	 */
+	float getStripCacheMissRatio() const { return mStripMissRatio; }
+
+	float getCacheMissRatio() const { return mMissRatio; }
+
+private:
+	static bool supportsBufferObjects();
+
+	void addGridVertex(landscape *ls, int x, int y, int v, int previous);
+
+	float levelError(const terrainChunk *chunk, int level);
+
+	void buildOccluderCells(terrainChunk *chunk);
+
+	void buildLevels();
+
+	int addLevelStrip(int level, int mask, int n);
+
+	void optimizeLevels();
+
+	int chunkLevel(int cx, int cy) const;
+
+	void quantize();
+
+	void upload();
+
+	void setChunkArrays(const terrainChunk *chunk);
+
+	void sortFrontToBack(const HorizonCuller *horizon);
+
+	void addOccluders(HorizonCuller *horizon, const terrainChunk *chunk);
+
+	bool isLightingDirty(int cx, int cy) const;
+
+	void lightChunk(int cx, int cy);
+
+	void updateLighting();
+
+	static const int sLevelSteps[TERRAIN_LOD_LEVELS];
+
+	TerrainVertexFormat mRequestedFormat;
+	TerrainVertexFormat mFormat;
+	terrainVertex *mVertices;
+	terrainShortVertex *mShortVertices;
+	// Texture coordinate units per quantized step.
+	float mTexcoordStep;
+	GLushort *mIndices;
+	// RGBA per vertex, kept when the geometry is released.
+	GLubyte *mColors;
+	int mNumColors;
+	// Where the colours start in the vertex buffer.
+	int mColorOffset;
+	int mNumVertices;
+	int mNumIndices;
+
+	terrainChunk *mChunks;
+	// Chunk indices in the order they are drawn.
+	int *mDrawOrder;
+	int mNumChunks;
+	int mChunksPerSide;
+	// The lowest top of any chunk.
+	float mLowestTop;
+
+	// The landscape the colours were computed from.
+	landscape *mLandscape;
+	float mSun[3];
+	float mAmbient;
+	// Segments whose lighting is out of date, [begin, end).
+	int mLightingBegin;
+	int mLightingEnd;
+	terrainLevelSet mLevelSets[TERRAIN_LOD_LEVELS][TERRAIN_LOD_MASKS];
+	// GL_TRIANGLE_STRIP or GL_TRIANGLES.
+	GLenum mPrimitive;
+	float mStripMissRatio;
+	float mMissRatio;
+	int mDrawnChunks;
+	int mCulledChunks;
+	int mOccludedChunks;
+
+	bool mUseBuffers;
+	GLuint mVertexBuffer;
+	GLuint mIndexBuffer;
+};
+
+#endif /* TERRAINMESH_H_ */
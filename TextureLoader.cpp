@@ -0,0 +1,348 @@
+/*
+ * TextureLoader.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include <mastdlib.h>
+#include <conprint.h>
+#include "TextureLoader.h"
+#include "MemoryTracker.h"
+
+#define KTX_HEADER_SIZE 64
+#define KTX_ENDIANNESS 0x04030201
+
+struct ktxHeader{
+	unsigned char identifier[12];
+	unsigned int endianness;
+	unsigned int glType;
+	unsigned int glTypeSize;
+	unsigned int glFormat;
+	unsigned int glInternalFormat;
+	unsigned int glBaseInternalFormat;
+	unsigned int pixelWidth;
+	unsigned int pixelHeight;
+	unsigned int pixelDepth;
+	unsigned int numberOfArrayElements;
+	unsigned int numberOfFaces;
+	unsigned int numberOfMipmapLevels;
+	unsigned int bytesOfKeyValueData;
+};
+
+static const unsigned char sKtxIdentifier[12] = {
+	0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'
+};
+
+static int sTextureMemory = 0;
+
+/**
+ * GL_GENERATE_MIPMAP is core in OpenGL ES 1.1 but not in 1.0.
+ */
+static bool canGenerateMipmaps()
+{
+	const char *version = (const char *)glGetString(GL_VERSION);
+	return version != NULL && strstr(version, " 1.0") == NULL;
+}
+
+static int numMipLevels(int width, int height)
+{
+	int levels = 1;
+	while(width > 1 || height > 1)
+	{
+		width = (width > 1) ? width / 2 : 1;
+		height = (height > 1) ? height / 2 : 1;
+		levels++;
+	}
+	return levels;
+}
+
+/**
+ * Bytes used by a full chain of uncompressed RGBA levels.
+ */
+static int mipChainSize(int width, int height)
+{
+	int size = 0;
+	for(int i = numMipLevels(width, height); i > 0; i--)
+	{
+		size += width * height * 4;
+		width = (width > 1) ? width / 2 : 1;
+		height = (height > 1) ? height / 2 : 1;
+	}
+	return size;
+}
+
+GLuint TextureLoader::loadImage(MAHandle image)
+{
+	MAExtent size = maGetImageSize(image);
+	int width = EXTENT_X(size);
+	int height = EXTENT_Y(size);
+
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	bool generate = canGenerateMipmaps();
+	if(generate)
+	{
+		// Let the GL build the chain from the base level.
+		glHint(GL_GENERATE_MIPMAP_HINT, GL_NICEST);
+		glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE);
+	}
+	// The base level straight from the image, never copied to RAM.
+	if(maOpenGLTexImage2D(image) < 0)
+	{
+		lprintfln("TextureLoader: could not upload image %d", image);
+		glDeleteTextures(1, &texture);
+		return 0;
+	}
+	bool mipmapped = generate || uploadMipLevels(image, width, height);
+
+	setFilters(mipmapped);
+	sTextureMemory += mipmapped ? mipChainSize(width, height) : width * height * 4;
+	return texture;
+}
+
+/**
+ * Rows of one mip level on their way to the GL.
+ */
+struct mipBand{
+	unsigned char *rows;
+	int width;
+	int height;
+	// Level row of the first row in the band, and rows in it.
+	int y;
+	int filled;
+};
+
+/**
+ * Upload the band, except the base level's, and box filter its
+ * pairs of rows into the next level's band, flushing that one
+ * whenever it fills up.
+ */
+static void flushMipBand(mipBand *bands, int level, int levels)
+{
+	mipBand *band = &bands[level];
+	if(level > 0)
+	{
+		glTexSubImage2D(GL_TEXTURE_2D, level, 0, band->y, band->width, band->filled,
+			GL_RGBA, GL_UNSIGNED_BYTE, band->rows);
+	}
+	if(level + 1 < levels)
+	{
+		mipBand *next = &bands[level + 1];
+		for(int y = 0; y < band->filled && next->y + next->filled < next->height; y += 2)
+		{
+			const unsigned char *row0 = band->rows + y * band->width * 4;
+			const unsigned char *row1 = (y + 1 < band->filled) ? row0 + band->width * 4 : row0;
+			unsigned char *out = next->rows + next->filled * next->width * 4;
+			for(int x = 0; x < next->width; x++)
+			{
+				int x0 = x * 2 * 4;
+				int x1 = (x * 2 + 1 < band->width) ? x0 + 4 : x0;
+				for(int c = 0; c < 4; c++)
+				{
+					int sum = row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+					out[x * 4 + c] = (sum + 2) >> 2;
+				}
+			}
+			next->filled++;
+			if(next->filled == TEXTURE_MIP_BAND_ROWS || next->y + next->filled == next->height)
+			{
+				flushMipBand(bands, level + 1, levels);
+			}
+		}
+	}
+	band->y += band->filled;
+	band->filled = 0;
+}
+
+/**
+ * Upload box filtered mip levels below the base level as RGBA.
+ * The image is read TEXTURE_MIP_BAND_ROWS rows at a time and
+ * every level keeps a band of as many rows, so nothing near the
+ * size of the image is held in RAM.
+ * @return false, with only the base level, if the bands don't fit.
+ */
+bool TextureLoader::uploadMipLevels(MAHandle image, int width, int height)
+{
+	int levels = numMipLevels(width, height);
+	mipBand bands[32];
+	int bytes = 0;
+	for(int level = 0, w = width, h = height; level < levels; level++)
+	{
+		bands[level].width = w;
+		bands[level].height = h;
+		bands[level].y = 0;
+		bands[level].filled = 0;
+		bytes += w * TEXTURE_MIP_BAND_ROWS * 4;
+		w = (w > 1) ? w / 2 : 1;
+		h = (h > 1) ? h / 2 : 1;
+	}
+	unsigned char *buffer = (unsigned char *)memAlloc(bytes, MEMTAG_RENDER);
+	if(buffer == NULL)
+	{
+		lprintfln("TextureLoader: no room for %d bytes of mip bands, image %d is not mipmapped",
+			bytes, image);
+		return false;
+	}
+	for(int level = 0, offset = 0; level < levels; level++)
+	{
+		bands[level].rows = buffer + offset;
+		offset += bands[level].width * TEXTURE_MIP_BAND_ROWS * 4;
+
+		// Storage for the level, filled in bands.
+		if(level > 0)
+		{
+			glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, bands[level].width, bands[level].height,
+				0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		}
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	mipBand *base = &bands[0];
+	while(base->y < height)
+	{
+		int rows = height - base->y;
+		rows = (rows < TEXTURE_MIP_BAND_ROWS) ? rows : TEXTURE_MIP_BAND_ROWS;
+		MARect rect = {0, base->y, width, rows};
+		int *pixels = (int *)base->rows;
+		maGetImageData(image, pixels, &rect, width);
+
+		// ARGB words to RGBA bytes.
+		for(int i = 0; i < width * rows; i++)
+		{
+			unsigned int argb = pixels[i];
+			base->rows[i * 4] = (argb >> 16) & 0xFF;
+			base->rows[i * 4 + 1] = (argb >> 8) & 0xFF;
+			base->rows[i * 4 + 2] = argb & 0xFF;
+			base->rows[i * 4 + 3] = (argb >> 24) & 0xFF;
+		}
+		base->filled = rows;
+		flushMipBand(bands, 0, levels);
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	memFree(buffer);
+	return true;
+}
+
+/**
+ * Read the header of a KTX resource, if it is a compressed one
+ * in a format the GL supports.
+ */
+static bool readKtxHeader(MAHandle ktx, ktxHeader *header)
+{
+	if(maGetDataSize(ktx) < KTX_HEADER_SIZE)
+	{
+		return false;
+	}
+	maReadData(ktx, header, 0, KTX_HEADER_SIZE);
+	if(memcmp(header->identifier, sKtxIdentifier, sizeof(sKtxIdentifier)) != 0 ||
+		header->endianness != KTX_ENDIANNESS ||
+		header->glType != 0)
+	{
+		lprintfln("TextureLoader: resource %d is not a compressed KTX texture", ktx);
+		return false;
+	}
+	return TextureLoader::isFormatSupported(header->glInternalFormat);
+}
+
+int TextureLoader::getLoadSize(MAHandle ktx, MAHandle image)
+{
+	ktxHeader header;
+	if(ktx == 0 || !readKtxHeader(ktx, &header))
+	{
+		MAExtent size = maGetImageSize(image);
+		return mipChainSize(EXTENT_X(size), EXTENT_Y(size));
+	}
+	int levels = (header.numberOfMipmapLevels > 0) ? header.numberOfMipmapLevels : 1;
+	int offset = KTX_HEADER_SIZE + header.bytesOfKeyValueData;
+	int size = 0;
+	for(int level = 0; level < levels; level++)
+	{
+		int imageSize;
+		maReadData(ktx, &imageSize, offset, sizeof(int));
+		size += imageSize;
+		offset += sizeof(int) + ((imageSize + 3) & ~3);
+	}
+	return size;
+}
+
+GLuint TextureLoader::loadCompressed(MAHandle ktx, MAHandle fallbackImage)
+{
+	ktxHeader header;
+	if(!readKtxHeader(ktx, &header))
+	{
+		return loadImage(fallbackImage);
+	}
+
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	MemoryTagScope scope(MEMTAG_RENDER);
+	int levels = (header.numberOfMipmapLevels > 0) ? header.numberOfMipmapLevels : 1;
+	int width = header.pixelWidth;
+	int height = header.pixelHeight;
+	int offset = KTX_HEADER_SIZE + header.bytesOfKeyValueData;
+	for(int level = 0; level < levels; level++)
+	{
+		int imageSize;
+		maReadData(ktx, &imageSize, offset, sizeof(int));
+		offset += sizeof(int);
+
+		char *data = new char[imageSize];
+		maReadData(ktx, data, offset, imageSize);
+		glCompressedTexImage2D(GL_TEXTURE_2D, level, header.glInternalFormat,
+			width, height, 0, imageSize, data);
+		delete[] data;
+
+		sTextureMemory += imageSize;
+		offset += (imageSize + 3) & ~3;
+		width = (width > 1) ? width / 2 : 1;
+		height = (height > 1) ? height / 2 : 1;
+	}
+
+	// Mipmap filtering needs every level down to 1x1.
+	setFilters(levels == numMipLevels(header.pixelWidth, header.pixelHeight));
+	return texture;
+}
+
+bool TextureLoader::isFormatSupported(GLenum format)
+{
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count);
+	if(count <= 0)
+	{
+		return false;
+	}
+
+	MemoryTagScope scope(MEMTAG_RENDER);
+	GLint *formats = new GLint[count];
+	glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats);
+	bool supported = false;
+	for(int i = 0; i < count; i++)
+	{
+		if((GLenum)formats[i] == format)
+		{
+			supported = true;
+			break;
+		}
+	}
+	delete[] formats;
+	return supported;
+}
+
+int TextureLoader::getTextureMemory()
+{
+	return sTextureMemory;
+}
+
+void TextureLoader::setFilters(bool mipmapped)
+{
+	// Nearest mip level, bilinear within it: cheap, and at grazing
+	// angles it keeps the fetches in the smaller levels.
+	glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+		mipmapped ? GL_LINEAR_MIPMAP_NEAREST : GL_LINEAR);
+	glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
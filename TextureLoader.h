@@ -0,0 +1,75 @@
+/*
+ * TextureLoader.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef TEXTURELOADER_H_
+#define TEXTURELOADER_H_
+
+#include <ma.h>
+#include <GLES/gl.h>
+
+// Rows of each mip level box filtered and uploaded at a time
+// when the GL can't generate the levels itself.
+#define TEXTURE_MIP_BAND_ROWS 8
+
+#ifndef GL_ETC1_RGB8_OES
+#define GL_ETC1_RGB8_OES 0x8D64
+#endif
+#ifndef GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG
+#define GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG 0x8C00
+#define GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG 0x8C01
+#define GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG 0x8C02
+#define GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG 0x8C03
+#endif
+
+/**
+ * Creates mipmapped GL textures from resources.
+ *
+ * Image resources get a full mip chain, generated by the GL
+ * where OpenGL ES 1.1 is available and box filtered on the CPU
+ * otherwise. Compressed textures are read from KTX files (as
+ * written by etc1tool or PVRTexTool) and are used when the GL
+ * lists their format, with a fallback image used if not.
+ */
+class TextureLoader
+{
+public:
+	/**
+	 * Load an image resource into a new mipmapped texture.
+	 * @return The texture name, or 0 on failure.
+	 */
+	static GLuint loadImage(MAHandle image);
+
+	/**
+	 * Load a KTX resource holding an ETC1 or PVRTC texture with
+	 * its mip levels. If the format is not supported by the device
+	 * the fallback image is loaded instead.
+	 * @return The texture name, or 0 on failure.
+	 */
+	static GLuint loadCompressed(MAHandle ktx, MAHandle fallbackImage);
+
+	/**
+	 * Whether the GL can sample the given compressed format.
+	 */
+	static bool isFormatSupported(GLenum format);
+
+	/**
+	 * Bytes of texture memory loading the KTX resource, or the
+	 * image when ktx is 0 or can't be used, would take.
+	 */
+	static int getLoadSize(MAHandle ktx, MAHandle image);
+
+	/**
+	 * Bytes of texture memory uploaded by the loader so far.
+	 */
+	static int getTextureMemory();
+
+private:
+	static void setFilters(bool mipmapped);
+
+	static bool uploadMipLevels(MAHandle image, int width, int height);
+};
+
+#endif /* TEXTURELOADER_H_ */
@@ -0,0 +1,388 @@
+/*
+ * TextureManager.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include <mastdlib.h>
+#include <conprint.h>
+#include "TextureManager.h"
+#include "TextureLoader.h"
+#include "GLStateCache.h"
+#include "MemoryTracker.h"
+
+TextureManager::TextureManager(GLStateCache *state):
+	mState(state),
+	mBudget(TEXTURE_DEFAULT_BUDGET),
+	mResidentBytes(0),
+	mFrame(0),
+	mLoads(0),
+	mEvictions(0)
+{
+	memset(mEntries, 0, sizeof(mEntries));
+}
+
+TextureManager::~TextureManager()
+{
+	for(int i = 0; i < TEXTURE_MAX_ENTRIES; i++)
+	{
+		if(mEntries[i].name != 0)
+		{
+			glDeleteTextures(1, &mEntries[i].name);
+		}
+	}
+}
+
+int TextureManager::newEntry()
+{
+	for(int i = 0; i < TEXTURE_MAX_ENTRIES; i++)
+	{
+		if(mEntries[i].refCount == 0)
+		{
+			textureEntry *entry = &mEntries[i];
+			memset(entry, 0, sizeof(textureEntry));
+			entry->atlas = -1;
+			return i;
+		}
+	}
+	maPanic(0, "TextureManager: too many textures");
+	return -1;
+}
+
+TextureHandle TextureManager::acquire(MAHandle image, MAHandle ktx)
+{
+	for(int i = 0; i < TEXTURE_MAX_ENTRIES; i++)
+	{
+		textureEntry *entry = &mEntries[i];
+		if(entry->refCount > 0 && !entry->isAtlas &&
+			entry->image == image && entry->ktx == ktx)
+		{
+			entry->refCount++;
+			return i + 1;
+		}
+	}
+
+	int index = newEntry();
+	textureEntry *entry = &mEntries[index];
+	MAExtent size = maGetImageSize(image);
+	entry->image = image;
+	entry->ktx = ktx;
+	entry->width = EXTENT_X(size);
+	entry->height = EXTENT_Y(size);
+	entry->refCount = 1;
+	return index + 1;
+}
+
+void TextureManager::addRef(TextureHandle texture)
+{
+	mEntries[texture - 1].refCount++;
+}
+
+TextureHandle TextureManager::addExternal(int bytes)
+{
+	makeRoom(bytes);
+	int index = newEntry();
+	textureEntry *entry = &mEntries[index];
+	entry->isExternal = true;
+	entry->bytes = bytes;
+	entry->refCount = 1;
+	mResidentBytes += bytes;
+	return index + 1;
+}
+
+void TextureManager::release(TextureHandle texture)
+{
+	textureEntry *entry = &mEntries[texture - 1];
+	if(--entry->refCount > 0)
+	{
+		return;
+	}
+	if(entry->isExternal)
+	{
+		mResidentBytes -= entry->bytes;
+		return;
+	}
+	unload(entry);
+	// Its space in the atlas stays unused.
+	if(entry->atlas >= 0)
+	{
+		release(entry->atlas + 1);
+	}
+}
+
+/**
+ * Shelf packing: images sorted by height are placed in rows,
+ * a row as high as its first image. A new atlas is started
+ * when an image fits in no row of the current one.
+ */
+void TextureManager::packAtlases()
+{
+	int order[TEXTURE_MAX_ENTRIES];
+	int count = 0;
+	for(int i = 0; i < TEXTURE_MAX_ENTRIES; i++)
+	{
+		textureEntry *entry = &mEntries[i];
+		if(entry->refCount > 0 && !entry->isAtlas && entry->atlas < 0 &&
+			entry->ktx == 0 && entry->width > 0 && entry->height > 0 &&
+			entry->width <= TEXTURE_ATLAS_MAX_IMAGE &&
+			entry->height <= TEXTURE_ATLAS_MAX_IMAGE)
+		{
+			int j = count++;
+			while(j > 0 && mEntries[order[j - 1]].height < entry->height)
+			{
+				order[j] = order[j - 1];
+				j--;
+			}
+			order[j] = i;
+		}
+	}
+	// One image gains nothing from an atlas.
+	if(count < 2)
+	{
+		return;
+	}
+
+	int created[TEXTURE_MAX_ENTRIES];
+	int numCreated = 0;
+	int atlas = -1;
+	int x = 0;
+	int y = 0;
+	int rowHeight = 0;
+	for(int i = 0; i < count; i++)
+	{
+		textureEntry *entry = &mEntries[order[i]];
+		int width = entry->width + TEXTURE_ATLAS_PADDING;
+		int height = entry->height + TEXTURE_ATLAS_PADDING;
+		if(atlas >= 0 && x + width > TEXTURE_ATLAS_SIZE)
+		{
+			x = 0;
+			y += rowHeight;
+			rowHeight = 0;
+		}
+		if(atlas < 0 || y + height > TEXTURE_ATLAS_SIZE)
+		{
+			atlas = newEntry();
+			mEntries[atlas].isAtlas = true;
+			mEntries[atlas].width = TEXTURE_ATLAS_SIZE;
+			mEntries[atlas].height = TEXTURE_ATLAS_SIZE;
+			// Keeps the entry taken until its members are added.
+			mEntries[atlas].refCount = 1;
+			created[numCreated++] = atlas;
+			x = 0;
+			y = 0;
+			rowHeight = 0;
+		}
+		rowHeight = (height > rowHeight) ? height : rowHeight;
+
+		// Each member holds a reference to its atlas.
+		mEntries[atlas].refCount++;
+		unload(entry);
+		entry->atlas = atlas;
+		entry->x = x;
+		entry->y = y;
+		x += width;
+	}
+
+	for(int i = 0; i < numCreated; i++)
+	{
+		mEntries[created[i]].refCount--;
+	}
+}
+
+GLuint TextureManager::bind(TextureHandle texture)
+{
+	if(texture <= 0)
+	{
+		mState->bindTexture(0);
+		return 0;
+	}
+	textureEntry *entry = &mEntries[texture - 1];
+	if(entry->atlas >= 0)
+	{
+		entry->lastUsed = mFrame;
+		entry = &mEntries[entry->atlas];
+	}
+	entry->lastUsed = mFrame;
+
+	if(entry->name == 0 && !load(entry))
+	{
+		return 0;
+	}
+	mState->bindTexture(entry->name);
+	return entry->name;
+}
+
+void TextureManager::getTexcoordRect(TextureHandle texture, float *rect) const
+{
+	const textureEntry *entry = &mEntries[texture - 1];
+	if(entry->atlas < 0)
+	{
+		rect[0] = rect[1] = 0.0f;
+		rect[2] = rect[3] = 1.0f;
+		return;
+	}
+	rect[0] = (float)entry->x / TEXTURE_ATLAS_SIZE;
+	rect[1] = (float)entry->y / TEXTURE_ATLAS_SIZE;
+	rect[2] = (float)entry->width / TEXTURE_ATLAS_SIZE;
+	rect[3] = (float)entry->height / TEXTURE_ATLAS_SIZE;
+}
+
+int TextureManager::getSize(TextureHandle texture) const
+{
+	const textureEntry *entry = &mEntries[texture - 1];
+	if(entry->atlas >= 0)
+	{
+		return 0;
+	}
+	return estimateSize(entry);
+}
+
+void TextureManager::invalidate()
+{
+	// External textures stay charged until their owners release
+	// them.
+	mResidentBytes = 0;
+	for(int i = 0; i < TEXTURE_MAX_ENTRIES; i++)
+	{
+		textureEntry *entry = &mEntries[i];
+		entry->name = 0;
+		if(entry->isExternal && entry->refCount > 0)
+		{
+			mResidentBytes += entry->bytes;
+		}
+	}
+}
+
+/**
+ * Texture memory the entry will take: the last size it had, or
+ * what the loader will upload for it, compressed or RGBA.
+ */
+int TextureManager::estimateSize(const textureEntry *entry) const
+{
+	if(entry->bytes > 0)
+	{
+		return entry->bytes;
+	}
+	if(entry->isAtlas)
+	{
+		return entry->width * entry->height * 4;
+	}
+	return TextureLoader::getLoadSize(entry->ktx, entry->image);
+}
+
+/**
+ * Evict the least recently bound textures until bytes more
+ * fit in the budget. Textures bound this frame are kept, and
+ * the budget is exceeded if that's not enough.
+ */
+void TextureManager::makeRoom(int bytes)
+{
+	while(mResidentBytes + bytes > mBudget)
+	{
+		textureEntry *oldest = NULL;
+		for(int i = 0; i < TEXTURE_MAX_ENTRIES; i++)
+		{
+			textureEntry *entry = &mEntries[i];
+			if(entry->name != 0 && entry->lastUsed < mFrame &&
+				(oldest == NULL || entry->lastUsed < oldest->lastUsed))
+			{
+				oldest = entry;
+			}
+		}
+		if(oldest == NULL)
+		{
+			lprintfln("TextureManager: %d bytes resident, over the budget of %d",
+				mResidentBytes + bytes, mBudget);
+			return;
+		}
+		unload(oldest);
+		mEvictions++;
+	}
+}
+
+void TextureManager::unload(textureEntry *entry)
+{
+	if(entry->name == 0)
+	{
+		return;
+	}
+	mState->deleteTexture(entry->name);
+	mResidentBytes -= entry->bytes;
+	entry->name = 0;
+}
+
+bool TextureManager::load(textureEntry *entry)
+{
+	makeRoom(estimateSize(entry));
+
+	int before = TextureLoader::getTextureMemory();
+	if(entry->isAtlas)
+	{
+		entry->name = loadAtlas(entry - mEntries);
+		entry->bytes = entry->width * entry->height * 4;
+	}
+	else
+	{
+		entry->name = (entry->ktx != 0) ?
+			TextureLoader::loadCompressed(entry->ktx, entry->image) :
+			TextureLoader::loadImage(entry->image);
+		entry->bytes = TextureLoader::getTextureMemory() - before;
+	}
+	// The loader binds textures behind the cache's back.
+	mState->forgetTexture();
+
+	if(entry->name == 0)
+	{
+		return false;
+	}
+	mResidentBytes += entry->bytes;
+	mLoads++;
+	return true;
+}
+
+/**
+ * Create the atlas texture and copy its members' images into it,
+ * one at a time so only the largest needs a buffer.
+ */
+GLuint TextureManager::loadAtlas(int atlas)
+{
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, TEXTURE_ATLAS_SIZE, TEXTURE_ATLAS_SIZE, 0,
+		GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	MemoryTagScope scope(MEMTAG_RENDER);
+	int *pixels = new int[TEXTURE_ATLAS_MAX_IMAGE * TEXTURE_ATLAS_MAX_IMAGE];
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for(int i = 0; i < TEXTURE_MAX_ENTRIES; i++)
+	{
+		textureEntry *entry = &mEntries[i];
+		if(entry->refCount == 0 || entry->atlas != atlas)
+		{
+			continue;
+		}
+		MARect rect = {0, 0, entry->width, entry->height};
+		maGetImageData(entry->image, pixels, &rect, entry->width);
+
+		// ARGB words to RGBA bytes.
+		unsigned char *rgba = (unsigned char *)pixels;
+		for(int p = 0; p < entry->width * entry->height; p++)
+		{
+			unsigned int argb = pixels[p];
+			rgba[p * 4] = (argb >> 16) & 0xFF;
+			rgba[p * 4 + 1] = (argb >> 8) & 0xFF;
+			rgba[p * 4 + 2] = argb & 0xFF;
+			rgba[p * 4 + 3] = (argb >> 24) & 0xFF;
+		}
+		glTexSubImage2D(GL_TEXTURE_2D, 0, entry->x, entry->y, entry->width, entry->height,
+			GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	delete[] pixels;
+	return texture;
+}
@@ -0,0 +1,170 @@
+/*
+ * TextureManager.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef TEXTUREMANAGER_H_
+#define TEXTUREMANAGER_H_
+
+#include <ma.h>
+#include <GLES/gl.h>
+
+class GLStateCache;
+
+// Textures, atlases included, that can be registered at once.
+#define TEXTURE_MAX_ENTRIES 64
+
+// Texture memory to stay under, in bytes, until the owner sets
+// one from the textures it keeps resident, see setBudget().
+#define TEXTURE_DEFAULT_BUDGET (4 * 1024 * 1024)
+
+// Images no larger than this on either side are packed into
+// atlases of the given size, with a gap between them.
+#define TEXTURE_ATLAS_MAX_IMAGE 128
+#define TEXTURE_ATLAS_SIZE 512
+#define TEXTURE_ATLAS_PADDING 1
+
+// A texture registered with the manager, 0 is no texture.
+typedef int TextureHandle;
+
+struct textureEntry{
+	// Image resource, and the compressed KTX version or 0.
+	MAHandle image;
+	MAHandle ktx;
+	int width;
+	int height;
+	int refCount;
+	// The GL texture, 0 while not resident.
+	GLuint name;
+	// Texture memory it takes when resident.
+	int bytes;
+	// Frame it was last bound in.
+	int lastUsed;
+	// Packed images are drawn from the atlas entry, at the given
+	// pixel offset. Atlases have no image and atlas is -1.
+	bool isAtlas;
+	int atlas;
+	int x;
+	int y;
+	// Created and owned elsewhere, only charged to the budget.
+	bool isExternal;
+};
+
+/**
+ * Owns the renderer's textures.
+ *
+ * Textures are registered with acquire() and counted
+ * references. They are loaded on first bind, and the least
+ * recently bound are deleted when the resident textures go
+ * over the memory budget, to be loaded again when next bound.
+ *
+ * packAtlases() moves the small images registered so far into
+ * shared atlas textures, so drawing several of them needs one
+ * bind. Atlases are not mipmapped and don't wrap, a packed
+ * image's texture coordinates come from getTexcoordRect().
+ *
+ * Textures the renderer creates itself, e.g. render targets,
+ * are charged to the budget with addExternal().
+ */
+class TextureManager
+{
+public:
+	/**
+	 * Textures are bound and deleted through the state cache.
+	 */
+	TextureManager(GLStateCache *state);
+
+	~TextureManager();
+
+	/**
+	 * Texture memory to stay under. It should hold the textures
+	 * bound every frame, or they are reloaded every frame.
+	 */
+	void setBudget(int bytes) { mBudget = bytes; }
+
+	/**
+	 * Register an image resource, or take another reference to
+	 * it. With a KTX resource the compressed texture is used when
+	 * the device supports it, see TextureLoader.
+	 */
+	TextureHandle acquire(MAHandle image, MAHandle ktx = 0);
+
+	void addRef(TextureHandle texture);
+
+	/**
+	 * Charge a texture created elsewhere to the budget, evicting
+	 * others to make room. It is never evicted or bound by the
+	 * manager, release() drops the charge and leaves deleting the
+	 * texture to its owner.
+	 */
+	TextureHandle addExternal(int bytes);
+
+	/**
+	 * Drop a reference, the texture is deleted with the last one.
+	 */
+	void release(TextureHandle texture);
+
+	/**
+	 * Pack the small images registered so far into atlases.
+	 */
+	void packAtlases();
+
+	/**
+	 * Bind the texture, or its atlas, loading it if needed.
+	 * @return The GL texture, 0 if it could not be loaded.
+	 */
+	GLuint bind(TextureHandle texture);
+
+	/**
+	 * Where the image is in the texture bind() binds: s and t
+	 * offset, then s and t scale. 0, 0, 1, 1 if not packed.
+	 */
+	void getTexcoordRect(TextureHandle texture, float *rect) const;
+
+	/**
+	 * Texture memory the texture takes when resident, in the
+	 * format it is uploaded in. 0 for a packed image, its atlas
+	 * is charged instead.
+	 */
+	int getSize(TextureHandle texture) const;
+
+	/**
+	 * Start a new frame, textures bound in it are not evicted.
+	 */
+	void beginFrame() { mFrame++; }
+
+	/**
+	 * The GL context was lost, with all the textures in it.
+	 */
+	void invalidate();
+
+	int getResidentBytes() const { return mResidentBytes; }
+
+	int getLoads() const { return mLoads; }
+
+	int getEvictions() const { return mEvictions; }
+
+private:
+	int newEntry();
+
+	int estimateSize(const textureEntry *entry) const;
+
+	void makeRoom(int bytes);
+
+	void unload(textureEntry *entry);
+
+	bool load(textureEntry *entry);
+
+	GLuint loadAtlas(int atlas);
+
+	GLStateCache *mState;
+	textureEntry mEntries[TEXTURE_MAX_ENTRIES];
+	int mBudget;
+	int mResidentBytes;
+	int mFrame;
+	int mLoads;
+	int mEvictions;
+};
+
+#endif /* TEXTUREMANAGER_H_ */
@@ -0,0 +1,97 @@
+/*
+ * TripleBuffer.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef TRIPLEBUFFER_H_
+#define TRIPLEBUFFER_H_
+
+/**
+ * Hands complete values from one producer to one consumer
+ * without either of them waiting on the other.
+ *
+ * The producer fills the back buffer and publishes it, which
+ * swaps it with the middle buffer. The consumer takes the
+ * middle buffer, if something new was published, by swapping
+ * it with the front buffer it reads from. Neither side ever
+ * touches the buffer the other one owns, and a value that is
+ * published again before it was read is simply replaced, so
+ * the consumer always gets the latest complete value.
+ *
+ * All shared state is the middle index and the fresh flag,
+ * packed in one word that only changes through exchange().
+ * MoSync applications run on a single thread, where that is a
+ * plain read and write; with real threads it has to be an
+ * atomic exchange.
+ */
+template<class T>
+class TripleBuffer
+{
+public:
+	TripleBuffer():
+		mBack(0),
+		mMiddle(1),
+		mFront(2)
+	{
+	}
+
+	/**
+	 * The buffer the producer writes the next value into.
+	 */
+	T& getBack() { return mBuffers[mBack]; }
+
+	/**
+	 * Make the back buffer the latest value. The producer
+	 * gets a different buffer to write into.
+	 * @return true if this replaced a value the consumer
+	 * never took.
+	 */
+	bool publish()
+	{
+		int old = exchange(mBack | FRESH);
+		mBack = old & INDEX;
+		return (old & FRESH) != 0;
+	}
+
+	/**
+	 * Move to the latest published value, if there is one.
+	 * @return true if the front buffer changed.
+	 */
+	bool acquire()
+	{
+		if((mMiddle & FRESH) == 0)
+		{
+			return false;
+		}
+		int old = exchange(mFront);
+		mFront = old & INDEX;
+		return true;
+	}
+
+	/**
+	 * The value the consumer reads, stable until the next acquire().
+	 */
+	const T& getFront() const { return mBuffers[mFront]; }
+
+private:
+	enum { INDEX = 3, FRESH = 4 };
+
+	int exchange(int middle)
+	{
+		int old = mMiddle;
+		mMiddle = middle;
+		return old;
+	}
+
+	T mBuffers[3];
+	// Owned by the producer.
+	int mBack;
+	// Index of the middle buffer, with FRESH set when it holds
+	// a value the consumer hasn't taken yet.
+	volatile int mMiddle;
+	// Owned by the consumer.
+	int mFront;
+};
+
+#endif /* TRIPLEBUFFER_H_ */
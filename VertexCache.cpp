@@ -0,0 +1,271 @@
+/*
+ * VertexCache.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include <ma.h>
+#include <mastdlib.h>
+#include <madmath.h>
+#include "VertexCache.h"
+#include "MemoryTracker.h"
+
+// Weights of the vertex score, from Forsyth's article.
+#define SCORE_LAST_TRIANGLE 0.75f
+#define SCORE_VALENCE_BOOST 2.0f
+
+/**
+ * A FIFO of vertex indices, counting the misses.
+ */
+struct fifoCache{
+	int entries[VERTEX_CACHE_SIZE];
+	int count;
+	int next;
+	int misses;
+};
+
+static void cacheInit(fifoCache *cache)
+{
+	cache->count = 0;
+	cache->next = 0;
+	cache->misses = 0;
+}
+
+static void cacheAccess(fifoCache *cache, int index)
+{
+	for(int i = 0; i < cache->count; i++)
+	{
+		if(cache->entries[i] == index)
+		{
+			return;
+		}
+	}
+	cache->misses++;
+	cache->entries[cache->next] = index;
+	cache->next = (cache->next + 1) % VERTEX_CACHE_SIZE;
+	cache->count = (cache->count < VERTEX_CACHE_SIZE) ? cache->count + 1 : cache->count;
+}
+
+int VertexCache::stripMisses(const GLushort *indices, int numIndices, int *numTriangles)
+{
+	fifoCache cache;
+	cacheInit(&cache);
+	*numTriangles = 0;
+	for(int i = 0; i < numIndices; i++)
+	{
+		cacheAccess(&cache, indices[i]);
+		if(i >= 2 && indices[i] != indices[i - 1] &&
+			indices[i] != indices[i - 2] && indices[i - 1] != indices[i - 2])
+		{
+			(*numTriangles)++;
+		}
+	}
+	return cache.misses;
+}
+
+int VertexCache::triangleMisses(const GLushort *indices, int numIndices)
+{
+	fifoCache cache;
+	cacheInit(&cache);
+	for(int i = 0; i < numIndices; i++)
+	{
+		cacheAccess(&cache, indices[i]);
+	}
+	return cache.misses;
+}
+
+int VertexCache::stripToTriangles(const GLushort *strip, int numIndices, GLushort *triangles)
+{
+	int n = 0;
+	for(int i = 2; i < numIndices; i++)
+	{
+		GLushort a = strip[i - 2];
+		GLushort b = strip[i - 1];
+		GLushort c = strip[i];
+		if(a == b || b == c || a == c)
+		{
+			continue;
+		}
+		// Every other triangle of a strip is wound the other way.
+		if(i & 1)
+		{
+			GLushort t = a;
+			a = b;
+			b = t;
+		}
+		triangles[n++] = a;
+		triangles[n++] = b;
+		triangles[n++] = c;
+	}
+	return n;
+}
+
+/**
+ * Higher for vertices recently used, and for vertices with few
+ * triangles left, so lone ones get finished off.
+ */
+float VertexCache::vertexScore(int cachePosition, int remaining)
+{
+	if(remaining == 0)
+	{
+		return -1.0f;
+	}
+	float score = 0.0f;
+	if(cachePosition >= 0)
+	{
+		if(cachePosition < 3)
+		{
+			// Used by the last triangle. Deliberately lower than
+			// the next ones, so strips don't just double back.
+			score = SCORE_LAST_TRIANGLE;
+		}
+		else
+		{
+			float x = 1.0f - (float)(cachePosition - 3) / (VERTEX_CACHE_MODEL_SIZE - 3);
+			score = x * sqrt(x);
+		}
+	}
+	return score + SCORE_VALENCE_BOOST / sqrt((float)remaining);
+}
+
+void VertexCache::optimize(GLushort *triangles, int numIndices, int numVertices)
+{
+	int numTriangles = numIndices / 3;
+	if(numTriangles < 2)
+	{
+		return;
+	}
+
+	MemoryTagScope scope(MEMTAG_RENDER);
+	// Triangles of each vertex, packed: vertex v has
+	// adjacency[first[v]] to adjacency[first[v] + remaining[v]].
+	int *first = new int[numVertices + 1];
+	int *remaining = new int[numVertices];
+	int *adjacency = new int[numIndices];
+	float *score = new float[numVertices];
+	bool *added = new bool[numTriangles];
+	GLushort *output = new GLushort[numIndices];
+
+	memset(remaining, 0, numVertices * sizeof(int));
+	for(int i = 0; i < numIndices; i++)
+	{
+		remaining[triangles[i]]++;
+	}
+	first[0] = 0;
+	for(int v = 0; v < numVertices; v++)
+	{
+		first[v + 1] = first[v] + remaining[v];
+		remaining[v] = 0;
+	}
+	for(int t = 0; t < numTriangles; t++)
+	{
+		for(int j = 0; j < 3; j++)
+		{
+			int v = triangles[t * 3 + j];
+			adjacency[first[v] + remaining[v]++] = t;
+		}
+		added[t] = false;
+	}
+	for(int v = 0; v < numVertices; v++)
+	{
+		score[v] = vertexScore(-1, remaining[v]);
+	}
+
+	// The modelled LRU cache, with room for the three vertices
+	// pushed in before the oldest ones are dropped.
+	int cache[VERTEX_CACHE_MODEL_SIZE + 3];
+	int cacheSize = 0;
+	int n = 0;
+	while(n < numIndices)
+	{
+		// The best triangle using a cached vertex, or the best
+		// of all of them when none does.
+		int best = -1;
+		float bestScore = -1.0f;
+		for(int i = 0; i < cacheSize; i++)
+		{
+			int v = cache[i];
+			for(int j = first[v]; j < first[v] + remaining[v]; j++)
+			{
+				int t = adjacency[j];
+				const GLushort *tri = &triangles[t * 3];
+				float s = score[tri[0]] + score[tri[1]] + score[tri[2]];
+				if(s > bestScore)
+				{
+					best = t;
+					bestScore = s;
+				}
+			}
+		}
+		if(best < 0)
+		{
+			for(int t = 0; t < numTriangles; t++)
+			{
+				if(!added[t])
+				{
+					const GLushort *tri = &triangles[t * 3];
+					float s = score[tri[0]] + score[tri[1]] + score[tri[2]];
+					if(s > bestScore)
+					{
+						best = t;
+						bestScore = s;
+					}
+				}
+			}
+		}
+
+		const GLushort *tri = &triangles[best * 3];
+		added[best] = true;
+		for(int j = 0; j < 3; j++)
+		{
+			int v = tri[j];
+			output[n++] = v;
+
+			// Take the triangle off the vertex's list.
+			int *list = &adjacency[first[v]];
+			for(int k = 0; k < remaining[v]; k++)
+			{
+				if(list[k] == best)
+				{
+					list[k] = list[--remaining[v]];
+					break;
+				}
+			}
+		}
+
+		// Move the triangle's vertices to the front of the cache.
+		for(int j = 2; j >= 0; j--)
+		{
+			int v = tri[j];
+			int i = 0;
+			while(i < cacheSize && cache[i] != v)
+			{
+				i++;
+			}
+			if(i == cacheSize)
+			{
+				cacheSize++;
+			}
+			for(; i > 0; i--)
+			{
+				cache[i] = cache[i - 1];
+			}
+			cache[0] = v;
+		}
+		// Those pushed out are scored as uncached.
+		for(int i = 0; i < cacheSize; i++)
+		{
+			int v = cache[i];
+			score[v] = vertexScore((i < VERTEX_CACHE_MODEL_SIZE) ? i : -1, remaining[v]);
+		}
+		cacheSize = (cacheSize < VERTEX_CACHE_MODEL_SIZE) ? cacheSize : VERTEX_CACHE_MODEL_SIZE;
+	}
+
+	memcpy(triangles, output, numIndices * sizeof(GLushort));
+	delete[] first;
+	delete[] remaining;
+	delete[] adjacency;
+	delete[] score;
+	delete[] added;
+	delete[] output;
+}
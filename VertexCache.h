@@ -0,0 +1,60 @@
+/*
+ * VertexCache.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef VERTEXCACHE_H_
+#define VERTEXCACHE_H_
+
+#include <GLES/gl.h>
+
+// Entries of the post-transform cache the miss ratio is
+// measured against, a FIFO like most mobile GPUs have.
+#define VERTEX_CACHE_SIZE 16
+// Entries of the LRU cache the optimizer models. It is larger
+// than the real cache so vertices about to fall out of the real
+// one still score.
+#define VERTEX_CACHE_MODEL_SIZE 32
+
+/**
+ * Measures and improves how well indexed triangles reuse the
+ * vertices the GPU has already transformed.
+ *
+ * The measure is the average cache miss ratio, ACMR: vertices
+ * transformed per triangle, which is 0.5 for a perfect ordering
+ * of a large grid and 3 for no reuse at all.
+ */
+class VertexCache
+{
+public:
+	/**
+	 * Vertices missing the cache when drawing a triangle strip,
+	 * and the triangles in it that have any area.
+	 */
+	static int stripMisses(const GLushort *indices, int numIndices, int *numTriangles);
+
+	/**
+	 * Vertices missing the cache when drawing a triangle list.
+	 */
+	static int triangleMisses(const GLushort *indices, int numIndices);
+
+	/**
+	 * Write the triangles of a strip as a list, leaving out the
+	 * degenerate ones and keeping the winding. Returns the number
+	 * of indices written, at most 3 * (numIndices - 2).
+	 */
+	static int stripToTriangles(const GLushort *strip, int numIndices, GLushort *triangles);
+
+	/**
+	 * Reorder a triangle list in place for the cache, with Tom
+	 * Forsyth's linear-speed vertex cache optimization. Indices
+	 * must be below numVertices.
+	 */
+	static void optimize(GLushort *triangles, int numIndices, int numVertices);
+
+private:
+	static float vertexScore(int cachePosition, int remaining);
+};
+
+#endif /* VERTEXCACHE_H_ */
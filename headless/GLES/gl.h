@@ -0,0 +1,199 @@
+/*
+ * gl.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef HEADLESS_GLES_GL_H_
+#define HEADLESS_GLES_GL_H_
+
+/*
+ * The subset of OpenGL ES 1.1 used by the renderer, implemented
+ * by GLRecorder.cpp for headless runs. Values match the Khronos
+ * headers.
+ */
+
+typedef void GLvoid;
+typedef unsigned int GLenum;
+typedef unsigned char GLboolean;
+typedef unsigned int GLbitfield;
+typedef signed char GLbyte;
+typedef short GLshort;
+typedef int GLint;
+typedef int GLsizei;
+typedef unsigned char GLubyte;
+typedef unsigned short GLushort;
+typedef unsigned int GLuint;
+typedef float GLfloat;
+typedef float GLclampf;
+typedef int GLfixed;
+typedef int GLclampx;
+typedef long GLintptr;
+typedef long GLsizeiptr;
+
+#define GL_VERSION_ES_CM_1_0 1
+#define GL_VERSION_ES_CM_1_1 1
+
+#define GL_FALSE 0
+#define GL_TRUE 1
+#define GL_DEPTH_BUFFER_BIT 0x00000100
+#define GL_COLOR_BUFFER_BIT 0x00004000
+#define GL_POINTS 0x0000
+#define GL_LINES 0x0001
+#define GL_LINE_LOOP 0x0002
+#define GL_LINE_STRIP 0x0003
+#define GL_TRIANGLES 0x0004
+#define GL_TRIANGLE_STRIP 0x0005
+#define GL_TRIANGLE_FAN 0x0006
+#define GL_ONE 1
+#define GL_ZERO 0
+#define GL_SRC_ALPHA 0x0302
+#define GL_ONE_MINUS_SRC_ALPHA 0x0303
+#define GL_CULL_FACE 0x0B44
+#define GL_DEPTH_TEST 0x0B71
+#define GL_LESS 0x0201
+#define GL_LEQUAL 0x0203
+#define GL_BLEND 0x0BE2
+#define GL_LIGHTING 0x0B50
+#define GL_FOG 0x0B60
+#define GL_TEXTURE_2D 0x0DE1
+#define GL_POINT_SMOOTH 0x0B10
+#define GL_SCISSOR_TEST 0x0C11
+#define GL_ALPHA_TEST 0x0BC0
+#define GL_BYTE 0x1400
+#define GL_UNSIGNED_BYTE 0x1401
+#define GL_SHORT 0x1402
+#define GL_UNSIGNED_SHORT 0x1403
+#define GL_FLOAT 0x1406
+#define GL_FIXED 0x140C
+#define GL_MODELVIEW 0x1700
+#define GL_PROJECTION 0x1701
+#define GL_TEXTURE 0x1702
+#define GL_ALPHA 0x1906
+#define GL_RGB 0x1907
+#define GL_RGBA 0x1908
+#define GL_LUMINANCE 0x1909
+#define GL_VENDOR 0x1F00
+#define GL_RENDERER 0x1F01
+#define GL_VERSION 0x1F02
+#define GL_EXTENSIONS 0x1F03
+#define GL_NEAREST 0x2600
+#define GL_LINEAR 0x2601
+#define GL_NEAREST_MIPMAP_NEAREST 0x2700
+#define GL_LINEAR_MIPMAP_NEAREST 0x2701
+#define GL_NEAREST_MIPMAP_LINEAR 0x2702
+#define GL_LINEAR_MIPMAP_LINEAR 0x2703
+#define GL_TEXTURE_MAG_FILTER 0x2800
+#define GL_TEXTURE_MIN_FILTER 0x2801
+#define GL_TEXTURE_WRAP_S 0x2802
+#define GL_TEXTURE_WRAP_T 0x2803
+#define GL_REPEAT 0x2901
+#define GL_CLAMP_TO_EDGE 0x812F
+#define GL_GENERATE_MIPMAP 0x8191
+#define GL_GENERATE_MIPMAP_HINT 0x8192
+#define GL_NICEST 0x1102
+#define GL_FASTEST 0x1101
+#define GL_DONT_CARE 0x1100
+#define GL_FLAT 0x1D00
+#define GL_SMOOTH 0x1D01
+#define GL_VERTEX_ARRAY 0x8074
+#define GL_NORMAL_ARRAY 0x8075
+#define GL_COLOR_ARRAY 0x8076
+#define GL_TEXTURE_COORD_ARRAY 0x8078
+#define GL_POINT_SIZE_ARRAY_OES 0x8B9C
+#define GL_ARRAY_BUFFER 0x8892
+#define GL_ELEMENT_ARRAY_BUFFER 0x8893
+#define GL_STATIC_DRAW 0x88E4
+#define GL_DYNAMIC_DRAW 0x88E8
+#define GL_MAX_TEXTURE_SIZE 0x0D33
+#define GL_NUM_COMPRESSED_TEXTURE_FORMATS 0x86A2
+#define GL_COMPRESSED_TEXTURE_FORMATS 0x86A3
+#define GL_TEXTURE_ENV 0x2300
+#define GL_TEXTURE_ENV_MODE 0x2200
+#define GL_MODULATE 0x2100
+#define GL_REPLACE 0x1E01
+#define GL_NO_ERROR 0
+#define GL_OUT_OF_MEMORY 0x0505
+#define GL_UNPACK_ALIGNMENT 0x0CF5
+#define GL_PACK_ALIGNMENT 0x0D05
+#define GL_VIEWPORT 0x0BA2
+#define GL_MODELVIEW_MATRIX 0x0BA6
+#define GL_PROJECTION_MATRIX 0x0BA7
+#define GL_POINT_SPRITE_OES 0x8861
+#define GL_COORD_REPLACE_OES 0x8862
+#define GL_POINT_SIZE_MIN 0x8126
+#define GL_POINT_SIZE_MAX 0x8127
+#define GL_POINT_DISTANCE_ATTENUATION 0x8129
+#ifdef __cplusplus
+extern "C" {
+#endif
+void glActiveTexture(GLenum);
+void glAlphaFunc(GLenum, GLclampf);
+void glBindBuffer(GLenum, GLuint);
+void glBindTexture(GLenum, GLuint);
+void glBlendFunc(GLenum, GLenum);
+void glBufferData(GLenum, GLsizeiptr, const GLvoid*, GLenum);
+void glBufferSubData(GLenum, GLintptr, GLsizeiptr, const GLvoid*);
+void glClear(GLbitfield);
+void glClearColor(GLclampf, GLclampf, GLclampf, GLclampf);
+void glClearDepthf(GLclampf);
+void glClientActiveTexture(GLenum);
+void glColor4f(GLfloat, GLfloat, GLfloat, GLfloat);
+void glColor4ub(GLubyte, GLubyte, GLubyte, GLubyte);
+void glColorPointer(GLint, GLenum, GLsizei, const GLvoid*);
+void glCompressedTexImage2D(GLenum, GLint, GLenum, GLsizei, GLsizei, GLint, GLsizei, const GLvoid*);
+void glCopyTexImage2D(GLenum, GLint, GLenum, GLint, GLint, GLsizei, GLsizei, GLint);
+void glCopyTexSubImage2D(GLenum, GLint, GLint, GLint, GLint, GLint, GLsizei, GLsizei);
+void glCullFace(GLenum);
+void glDeleteBuffers(GLsizei, const GLuint*);
+void glDeleteTextures(GLsizei, const GLuint*);
+void glDepthFunc(GLenum);
+void glDepthMask(GLboolean);
+void glDisable(GLenum);
+void glDisableClientState(GLenum);
+void glDrawArrays(GLenum, GLint, GLsizei);
+void glDrawElements(GLenum, GLsizei, GLenum, const GLvoid*);
+void glEnable(GLenum);
+void glEnableClientState(GLenum);
+void glFinish(void);
+void glFlush(void);
+void glFrustumf(GLfloat, GLfloat, GLfloat, GLfloat, GLfloat, GLfloat);
+void glGenBuffers(GLsizei, GLuint*);
+void glGenTextures(GLsizei, GLuint*);
+GLenum glGetError(void);
+void glGetFloatv(GLenum, GLfloat*);
+void glGetIntegerv(GLenum, GLint*);
+const GLubyte* glGetString(GLenum);
+void glHint(GLenum, GLenum);
+void glLoadIdentity(void);
+void glLoadMatrixf(const GLfloat*);
+void glMatrixMode(GLenum);
+void glMultMatrixf(const GLfloat*);
+void glOrthof(GLfloat, GLfloat, GLfloat, GLfloat, GLfloat, GLfloat);
+void glPixelStorei(GLenum, GLint);
+void glPointParameterf(GLenum, GLfloat);
+void glPointParameterfv(GLenum, const GLfloat*);
+void glPointSize(GLfloat);
+void glPopMatrix(void);
+void glPushMatrix(void);
+void glReadPixels(GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, GLvoid*);
+void glRotatef(GLfloat, GLfloat, GLfloat, GLfloat);
+void glScalef(GLfloat, GLfloat, GLfloat);
+void glScissor(GLint, GLint, GLsizei, GLsizei);
+void glShadeModel(GLenum);
+void glTexCoordPointer(GLint, GLenum, GLsizei, const GLvoid*);
+void glTexEnvi(GLenum, GLenum, GLint);
+void glTexEnvf(GLenum, GLenum, GLfloat);
+void glTexImage2D(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const GLvoid*);
+void glTexParameteri(GLenum, GLenum, GLint);
+void glTexParameterx(GLenum, GLenum, GLfixed);
+void glTexParameterf(GLenum, GLenum, GLfloat);
+void glTexSubImage2D(GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, const GLvoid*);
+void glTranslatef(GLfloat, GLfloat, GLfloat);
+void glVertexPointer(GLint, GLenum, GLsizei, const GLvoid*);
+void glViewport(GLint, GLint, GLsizei, GLsizei);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HEADLESS_GLES_GL_H_ */
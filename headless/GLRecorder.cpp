@@ -0,0 +1,679 @@
+/*
+ * GLRecorder.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include <string.h>
+#include <map>
+#include <vector>
+#include "GLRecorder.h"
+
+struct arrayPointer{
+	bool enabled;
+	GLint size;
+	GLenum type;
+	GLsizei stride;
+	const GLvoid *pointer;
+	GLuint buffer;
+};
+
+struct recorderState{
+	glCounters frame;
+	glCounters total;
+	bool logging;
+	std::vector<glCommand> log;
+	const char *version;
+	const char *extensions;
+
+	std::map<GLenum, bool> caps;
+	arrayPointer vertexArray;
+	arrayPointer texCoordArray;
+	arrayPointer colorArray;
+	GLuint boundTexture;
+	GLuint arrayBuffer;
+	GLuint elementBuffer;
+	GLenum matrixMode;
+	GLfloat clearColor[4];
+	GLfloat pointSize;
+	GLint viewport[4];
+
+	GLuint nextName;
+	std::map<GLuint, std::vector<unsigned char> > buffers;
+};
+
+static recorderState sState = {
+	{0}, {0}, false, std::vector<glCommand>(),
+	"OpenGL ES-CM 1.1 GLRecorder", "",
+	std::map<GLenum, bool>(),
+	{false, 4, GL_FLOAT, 0, NULL, 0},
+	{false, 4, GL_FLOAT, 0, NULL, 0},
+	{false, 4, GL_FLOAT, 0, NULL, 0},
+	0, 0, 0, GL_MODELVIEW,
+	{0, 0, 0, 0}, 1.0f, {0, 0, 0, 0},
+	1, std::map<GLuint, std::vector<unsigned char> >()
+};
+
+#define FLOAT_ARG(f) ((int)((f) * 1000.0f))
+
+static void record(const char *name, int a = 0, int b = 0, int c = 0, int d = 0)
+{
+	sState.frame.calls++;
+	sState.total.calls++;
+	if(sState.logging)
+	{
+		glCommand command = {name, {a, b, c, d}};
+		sState.log.push_back(command);
+	}
+}
+
+#define COUNT(field, n) { sState.frame.field += (n); sState.total.field += (n); }
+
+static void stateChange(bool redundant)
+{
+	COUNT(stateChanges, 1);
+	if(redundant)
+	{
+		COUNT(redundantStateChanges, 1);
+	}
+}
+
+static int typeSize(GLenum type)
+{
+	switch(type)
+	{
+		case GL_BYTE:
+		case GL_UNSIGNED_BYTE:
+			return 1;
+		case GL_SHORT:
+		case GL_UNSIGNED_SHORT:
+			return 2;
+		default:
+			return 4;
+	}
+}
+
+static arrayPointer* clientArray(GLenum array)
+{
+	switch(array)
+	{
+		case GL_VERTEX_ARRAY: return &sState.vertexArray;
+		case GL_TEXTURE_COORD_ARRAY: return &sState.texCoordArray;
+		case GL_COLOR_ARRAY: return &sState.colorArray;
+		default: return NULL;
+	}
+}
+
+static void setPointer(arrayPointer *array, GLint size, GLenum type, GLsizei stride, const GLvoid *pointer)
+{
+	bool redundant = array->size == size && array->type == type &&
+		array->stride == stride && array->pointer == pointer &&
+		array->buffer == sState.arrayBuffer;
+	stateChange(redundant);
+	array->size = size;
+	array->type = type;
+	array->stride = stride;
+	array->pointer = pointer;
+	array->buffer = sState.arrayBuffer;
+}
+
+/**
+ * Bytes of the enabled arrays read for vertices [first, first + count).
+ */
+static int arrayBytes(int count)
+{
+	int bytes = 0;
+	arrayPointer *arrays[3] = {&sState.vertexArray, &sState.texCoordArray, &sState.colorArray};
+	for(int i = 0; i < 3; i++)
+	{
+		if(arrays[i]->enabled)
+		{
+			int element = arrays[i]->size * typeSize(arrays[i]->type);
+			int stride = arrays[i]->stride ? arrays[i]->stride : element;
+			bytes += (count - 1) * stride + element;
+		}
+	}
+	return bytes;
+}
+
+static void draw(GLenum mode, int vertices, int indices, int vertexRange, int indexBytes)
+{
+	COUNT(drawCalls, 1);
+	COUNT(vertices, vertices);
+	COUNT(indices, indices);
+	if(vertexRange > 0)
+	{
+		COUNT(bytesReferenced, arrayBytes(vertexRange) + indexBytes);
+	}
+}
+
+extern "C" {
+
+void glActiveTexture(GLenum texture)
+{
+	record("glActiveTexture", texture);
+	stateChange(false);
+}
+
+void glAlphaFunc(GLenum func, GLclampf ref)
+{
+	record("glAlphaFunc", func, FLOAT_ARG(ref));
+	stateChange(false);
+}
+
+void glBindBuffer(GLenum target, GLuint buffer)
+{
+	record("glBindBuffer", target, buffer);
+	GLuint *bound = (target == GL_ARRAY_BUFFER) ? &sState.arrayBuffer : &sState.elementBuffer;
+	stateChange(*bound == buffer);
+	*bound = buffer;
+}
+
+void glBindTexture(GLenum target, GLuint texture)
+{
+	record("glBindTexture", target, texture);
+	stateChange(sState.boundTexture == texture);
+	COUNT(textureBinds, 1);
+	sState.boundTexture = texture;
+}
+
+void glBlendFunc(GLenum sfactor, GLenum dfactor)
+{
+	record("glBlendFunc", sfactor, dfactor);
+	stateChange(false);
+}
+
+void glBufferData(GLenum target, GLsizeiptr size, const GLvoid *data, GLenum usage)
+{
+	record("glBufferData", target, size, usage);
+	GLuint buffer = (target == GL_ARRAY_BUFFER) ? sState.arrayBuffer : sState.elementBuffer;
+	std::vector<unsigned char> &storage = sState.buffers[buffer];
+	storage.resize(size);
+	if(data != NULL && size > 0)
+	{
+		memcpy(&storage[0], data, size);
+	}
+	COUNT(bytesUploaded, size);
+}
+
+void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid *data)
+{
+	record("glBufferSubData", target, offset, size);
+	GLuint buffer = (target == GL_ARRAY_BUFFER) ? sState.arrayBuffer : sState.elementBuffer;
+	std::vector<unsigned char> &storage = sState.buffers[buffer];
+	if(offset + size <= (GLintptr)storage.size() && size > 0)
+	{
+		memcpy(&storage[offset], data, size);
+	}
+	COUNT(bytesUploaded, size);
+}
+
+void glClear(GLbitfield mask)
+{
+	record("glClear", mask);
+}
+
+void glClearColor(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha)
+{
+	record("glClearColor", FLOAT_ARG(red), FLOAT_ARG(green), FLOAT_ARG(blue), FLOAT_ARG(alpha));
+	GLfloat color[4] = {red, green, blue, alpha};
+	stateChange(memcmp(color, sState.clearColor, sizeof(color)) == 0);
+	memcpy(sState.clearColor, color, sizeof(color));
+}
+
+void glClearDepthf(GLclampf depth)
+{
+	record("glClearDepthf", FLOAT_ARG(depth));
+	stateChange(false);
+}
+
+void glClientActiveTexture(GLenum texture)
+{
+	record("glClientActiveTexture", texture);
+	stateChange(false);
+}
+
+void glColor4f(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+	record("glColor4f", FLOAT_ARG(red), FLOAT_ARG(green), FLOAT_ARG(blue), FLOAT_ARG(alpha));
+	stateChange(false);
+}
+
+void glColor4ub(GLubyte red, GLubyte green, GLubyte blue, GLubyte alpha)
+{
+	record("glColor4ub", red, green, blue, alpha);
+	stateChange(false);
+}
+
+void glColorPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *pointer)
+{
+	record("glColorPointer", size, type, stride);
+	setPointer(&sState.colorArray, size, type, stride, pointer);
+}
+
+void glCompressedTexImage2D(GLenum target, GLint level, GLenum internalformat,
+	GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const GLvoid *data)
+{
+	record("glCompressedTexImage2D", level, internalformat, width, height);
+	COUNT(bytesUploaded, imageSize);
+}
+
+void glCopyTexImage2D(GLenum target, GLint level, GLenum internalformat,
+	GLint x, GLint y, GLsizei width, GLsizei height, GLint border)
+{
+	record("glCopyTexImage2D", level, internalformat, width, height);
+}
+
+void glCopyTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset,
+	GLint x, GLint y, GLsizei width, GLsizei height)
+{
+	record("glCopyTexSubImage2D", level, xoffset, width, height);
+}
+
+void glCullFace(GLenum mode)
+{
+	record("glCullFace", mode);
+	stateChange(false);
+}
+
+void glDeleteBuffers(GLsizei n, const GLuint *buffers)
+{
+	record("glDeleteBuffers", n);
+	for(int i = 0; i < n; i++)
+	{
+		sState.buffers.erase(buffers[i]);
+	}
+}
+
+void glDeleteTextures(GLsizei n, const GLuint *textures)
+{
+	record("glDeleteTextures", n);
+}
+
+void glDepthFunc(GLenum func)
+{
+	record("glDepthFunc", func);
+	stateChange(false);
+}
+
+void glDepthMask(GLboolean flag)
+{
+	record("glDepthMask", flag);
+	stateChange(false);
+}
+
+void glDisable(GLenum cap)
+{
+	record("glDisable", cap);
+	stateChange(!sState.caps[cap]);
+	sState.caps[cap] = false;
+}
+
+void glDisableClientState(GLenum array)
+{
+	record("glDisableClientState", array);
+	arrayPointer *pointer = clientArray(array);
+	stateChange(pointer != NULL && !pointer->enabled);
+	if(pointer != NULL)
+	{
+		pointer->enabled = false;
+	}
+}
+
+void glDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+	record("glDrawArrays", mode, first, count);
+	draw(mode, count, 0, count, 0);
+}
+
+void glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid *indices)
+{
+	record("glDrawElements", mode, count, type);
+
+	// Find the range of vertices the indices reference.
+	const unsigned char *data = (const unsigned char *)indices;
+	if(sState.elementBuffer != 0)
+	{
+		std::vector<unsigned char> &storage = sState.buffers[sState.elementBuffer];
+		size_t offset = (size_t)indices;
+		data = (offset < storage.size()) ? &storage[offset] : NULL;
+	}
+	int minIndex = 0;
+	int maxIndex = -1;
+	if(data != NULL && count > 0)
+	{
+		minIndex = 0x7FFFFFFF;
+		for(int i = 0; i < count; i++)
+		{
+			int index = (type == GL_UNSIGNED_BYTE) ?
+				data[i] : ((const GLushort *)data)[i];
+			if(index < minIndex) minIndex = index;
+			if(index > maxIndex) maxIndex = index;
+		}
+	}
+	draw(mode, count, count, maxIndex - minIndex + 1, count * typeSize(type));
+}
+
+void glEnable(GLenum cap)
+{
+	record("glEnable", cap);
+	stateChange(sState.caps[cap]);
+	sState.caps[cap] = true;
+}
+
+void glEnableClientState(GLenum array)
+{
+	record("glEnableClientState", array);
+	arrayPointer *pointer = clientArray(array);
+	stateChange(pointer != NULL && pointer->enabled);
+	if(pointer != NULL)
+	{
+		pointer->enabled = true;
+	}
+}
+
+void glFinish(void)
+{
+	record("glFinish");
+}
+
+void glFlush(void)
+{
+	record("glFlush");
+}
+
+void glFrustumf(GLfloat left, GLfloat right, GLfloat bottom, GLfloat top, GLfloat zNear, GLfloat zFar)
+{
+	record("glFrustumf", FLOAT_ARG(left), FLOAT_ARG(right), FLOAT_ARG(bottom), FLOAT_ARG(top));
+	COUNT(matrixOps, 1);
+}
+
+void glGenBuffers(GLsizei n, GLuint *buffers)
+{
+	record("glGenBuffers", n);
+	for(int i = 0; i < n; i++)
+	{
+		buffers[i] = sState.nextName++;
+	}
+}
+
+void glGenTextures(GLsizei n, GLuint *textures)
+{
+	record("glGenTextures", n);
+	for(int i = 0; i < n; i++)
+	{
+		textures[i] = sState.nextName++;
+	}
+}
+
+GLenum glGetError(void)
+{
+	record("glGetError");
+	return GL_NO_ERROR;
+}
+
+void glGetFloatv(GLenum pname, GLfloat *params)
+{
+	record("glGetFloatv", pname);
+	if(pname == GL_POINT_SIZE_MIN)
+	{
+		params[0] = 1.0f;
+	}
+	else if(pname == GL_POINT_SIZE_MAX)
+	{
+		params[0] = 64.0f;
+	}
+	else
+	{
+		params[0] = 0.0f;
+	}
+}
+
+void glGetIntegerv(GLenum pname, GLint *params)
+{
+	record("glGetIntegerv", pname);
+	switch(pname)
+	{
+		case GL_VIEWPORT:
+			memcpy(params, sState.viewport, sizeof(sState.viewport));
+			break;
+		case GL_MAX_TEXTURE_SIZE:
+			params[0] = 1024;
+			break;
+		default:
+			params[0] = 0;
+			break;
+	}
+}
+
+const GLubyte* glGetString(GLenum name)
+{
+	record("glGetString", name);
+	switch(name)
+	{
+		case GL_VENDOR:
+		case GL_RENDERER:
+			return (const GLubyte *)"GLRecorder";
+		case GL_VERSION:
+			return (const GLubyte *)sState.version;
+		case GL_EXTENSIONS:
+			return (const GLubyte *)sState.extensions;
+		default:
+			return NULL;
+	}
+}
+
+void glHint(GLenum target, GLenum mode)
+{
+	record("glHint", target, mode);
+}
+
+void glLoadIdentity(void)
+{
+	record("glLoadIdentity");
+	COUNT(matrixOps, 1);
+}
+
+void glLoadMatrixf(const GLfloat *m)
+{
+	record("glLoadMatrixf");
+	COUNT(matrixOps, 1);
+}
+
+void glMatrixMode(GLenum mode)
+{
+	record("glMatrixMode", mode);
+	stateChange(sState.matrixMode == mode);
+	sState.matrixMode = mode;
+}
+
+void glMultMatrixf(const GLfloat *m)
+{
+	record("glMultMatrixf");
+	COUNT(matrixOps, 1);
+}
+
+void glOrthof(GLfloat left, GLfloat right, GLfloat bottom, GLfloat top, GLfloat zNear, GLfloat zFar)
+{
+	record("glOrthof", FLOAT_ARG(left), FLOAT_ARG(right), FLOAT_ARG(bottom), FLOAT_ARG(top));
+	COUNT(matrixOps, 1);
+}
+
+void glPixelStorei(GLenum pname, GLint param)
+{
+	record("glPixelStorei", pname, param);
+}
+
+void glPointParameterf(GLenum pname, GLfloat param)
+{
+	record("glPointParameterf", pname, FLOAT_ARG(param));
+	stateChange(false);
+}
+
+void glPointParameterfv(GLenum pname, const GLfloat *params)
+{
+	record("glPointParameterfv", pname);
+	stateChange(false);
+}
+
+void glPointSize(GLfloat size)
+{
+	record("glPointSize", FLOAT_ARG(size));
+	stateChange(sState.pointSize == size);
+	sState.pointSize = size;
+}
+
+void glPopMatrix(void)
+{
+	record("glPopMatrix");
+	COUNT(matrixOps, 1);
+}
+
+void glPushMatrix(void)
+{
+	record("glPushMatrix");
+	COUNT(matrixOps, 1);
+}
+
+void glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, GLvoid *pixels)
+{
+	record("glReadPixels", x, y, width, height);
+	memset(pixels, 0, width * height * 4);
+}
+
+void glRotatef(GLfloat angle, GLfloat x, GLfloat y, GLfloat z)
+{
+	record("glRotatef", FLOAT_ARG(angle), FLOAT_ARG(x), FLOAT_ARG(y), FLOAT_ARG(z));
+	COUNT(matrixOps, 1);
+}
+
+void glScalef(GLfloat x, GLfloat y, GLfloat z)
+{
+	record("glScalef", FLOAT_ARG(x), FLOAT_ARG(y), FLOAT_ARG(z));
+	COUNT(matrixOps, 1);
+}
+
+void glScissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+	record("glScissor", x, y, width, height);
+	stateChange(false);
+}
+
+void glShadeModel(GLenum mode)
+{
+	record("glShadeModel", mode);
+	stateChange(false);
+}
+
+void glTexCoordPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *pointer)
+{
+	record("glTexCoordPointer", size, type, stride);
+	setPointer(&sState.texCoordArray, size, type, stride, pointer);
+}
+
+void glTexEnvi(GLenum target, GLenum pname, GLint param)
+{
+	record("glTexEnvi", target, pname, param);
+	stateChange(false);
+}
+
+void glTexEnvf(GLenum target, GLenum pname, GLfloat param)
+{
+	record("glTexEnvf", target, pname, FLOAT_ARG(param));
+	stateChange(false);
+}
+
+void glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height,
+	GLint border, GLenum format, GLenum type, const GLvoid *pixels)
+{
+	record("glTexImage2D", level, internalformat, width, height);
+	COUNT(bytesUploaded, width * height * 4);
+}
+
+void glTexParameteri(GLenum target, GLenum pname, GLint param)
+{
+	record("glTexParameteri", pname, param);
+	stateChange(false);
+}
+
+void glTexParameterx(GLenum target, GLenum pname, GLfixed param)
+{
+	record("glTexParameterx", pname, param);
+	stateChange(false);
+}
+
+void glTexParameterf(GLenum target, GLenum pname, GLfloat param)
+{
+	record("glTexParameterf", pname, FLOAT_ARG(param));
+	stateChange(false);
+}
+
+void glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height,
+	GLenum format, GLenum type, const GLvoid *pixels)
+{
+	record("glTexSubImage2D", level, xoffset, width, height);
+	COUNT(bytesUploaded, width * height * 4);
+}
+
+void glTranslatef(GLfloat x, GLfloat y, GLfloat z)
+{
+	record("glTranslatef", FLOAT_ARG(x), FLOAT_ARG(y), FLOAT_ARG(z));
+	COUNT(matrixOps, 1);
+}
+
+void glVertexPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *pointer)
+{
+	record("glVertexPointer", size, type, stride);
+	setPointer(&sState.vertexArray, size, type, stride, pointer);
+}
+
+void glViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+	record("glViewport", x, y, width, height);
+	GLint viewport[4] = {x, y, width, height};
+	stateChange(memcmp(viewport, sState.viewport, sizeof(viewport)) == 0);
+	memcpy(sState.viewport, viewport, sizeof(viewport));
+}
+
+}
+
+void GLRecorder::beginFrame()
+{
+	memset(&sState.frame, 0, sizeof(glCounters));
+	sState.log.clear();
+}
+
+const glCounters& GLRecorder::getFrameCounters()
+{
+	return sState.frame;
+}
+
+const glCounters& GLRecorder::getTotalCounters()
+{
+	return sState.total;
+}
+
+void GLRecorder::setLogging(bool enabled)
+{
+	sState.logging = enabled;
+}
+
+void GLRecorder::dumpLog(FILE *out)
+{
+	for(size_t i = 0; i < sState.log.size(); i++)
+	{
+		const glCommand &command = sState.log[i];
+		fprintf(out, "%5d %s(%d, %d, %d, %d)\n", (int)i, command.name,
+			command.args[0], command.args[1], command.args[2], command.args[3]);
+	}
+}
+
+void GLRecorder::setVersion(const char *version)
+{
+	sState.version = version;
+}
+
+void GLRecorder::setExtensions(const char *extensions)
+{
+	sState.extensions = extensions;
+}
@@ -0,0 +1,77 @@
+/*
+ * GLRecorder.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef GLRECORDER_H_
+#define GLRECORDER_H_
+
+#include <stdio.h>
+#include <GLES/gl.h>
+
+/**
+ * One recorded GL call. Integer arguments are kept as is,
+ * float arguments are stored as their value times 1000.
+ */
+struct glCommand{
+	const char *name;
+	int args[4];
+};
+
+struct glCounters{
+	// Every GL entry point called.
+	int calls;
+	int drawCalls;
+	// Vertices submitted, one per index for indexed draws.
+	int vertices;
+	int indices;
+	// Calls that change GL state, and how many of them
+	// set the state to the value it already had.
+	int stateChanges;
+	int redundantStateChanges;
+	int textureBinds;
+	int matrixOps;
+	// Vertex and index data read by draw calls.
+	int bytesReferenced;
+	// Data handed to glBufferData/glTexImage2D and friends.
+	int bytesUploaded;
+};
+
+/**
+ * An OpenGL ES 1.x implementation that draws nothing. Each call
+ * is appended to a command log and counted, and enough state is
+ * tracked to tell redundant state changes and the amount of
+ * vertex data a draw call touches. Linked instead of the device
+ * GL it lets the renderer run, and be measured, on a desktop.
+ */
+class GLRecorder
+{
+public:
+	/**
+	 * Start a new frame: clears the frame counters and the log.
+	 */
+	static void beginFrame();
+
+	static const glCounters& getFrameCounters();
+
+	static const glCounters& getTotalCounters();
+
+	/**
+	 * Keep the calls of the current frame in the command log.
+	 * Off by default, counting alone is cheaper.
+	 */
+	static void setLogging(bool enabled);
+
+	static void dumpLog(FILE *out);
+
+	/**
+	 * What glGetString returns, to exercise the renderer's
+	 * OpenGL ES 1.0 and extension paths.
+	 */
+	static void setVersion(const char *version);
+
+	static void setExtensions(const char *extensions);
+};
+
+#endif /* GLRECORDER_H_ */
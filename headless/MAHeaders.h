@@ -0,0 +1,18 @@
+/*
+ * MAHeaders.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef HEADLESS_MAHEADERS_H_
+#define HEADLESS_MAHEADERS_H_
+
+// Stand-ins for the resource handles the MoSync resource
+// compiler generates, see MoSyncStubs.cpp.
+#define LUNAR_TEXTURE 1
+#define LOCAL_FILES_BIN 2
+// Small images, from 16 to 192 pixels square, for --textures.
+#define SMALL_IMAGE_FIRST 16
+#define SMALL_IMAGE_COUNT 32
+
+#endif /* HEADLESS_MAHEADERS_H_ */
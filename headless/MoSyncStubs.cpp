@@ -0,0 +1,99 @@
+/*
+ * MoSyncStubs.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include <stdarg.h>
+#include <sys/time.h>
+#include <GLES/gl.h>
+#include <ma.h>
+#include <conprint.h>
+#include "MAHeaders.h"
+
+// LUNAR_TEXTURE is a generated checker image of this size.
+#define IMAGE_SIZE 256
+
+extern "C" {
+
+int maGetMilliSecondCount(void)
+{
+	static struct timeval start = {0, 0};
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	if(start.tv_sec == 0)
+	{
+		start = now;
+	}
+	return (int)((now.tv_sec - start.tv_sec) * 1000 +
+		(now.tv_usec - start.tv_usec) / 1000);
+}
+
+void maPanic(int result, const char *message)
+{
+	fprintf(stderr, "maPanic(%d): %s\n", result, message);
+	exit(1);
+}
+
+MAExtent maGetImageSize(MAHandle image)
+{
+	if(image == LUNAR_TEXTURE)
+	{
+		return EXTENT(IMAGE_SIZE, IMAGE_SIZE);
+	}
+	// Every fourth small image is too large for an atlas.
+	int small = image - SMALL_IMAGE_FIRST;
+	if(small >= 0 && small < SMALL_IMAGE_COUNT)
+	{
+		int side = (small % 4 == 3) ? 192 : (16 << (small % 3));
+		return EXTENT(side, side);
+	}
+	return 0;
+}
+
+void maGetImageData(MAHandle image, void *dst, const MARect *srcRect, int scanlength)
+{
+	int *pixels = (int *)dst;
+	for(int y = 0; y < srcRect->height; y++)
+	{
+		for(int x = 0; x < srcRect->width; x++)
+		{
+			int gray = (((srcRect->left + x) ^ (srcRect->top + y)) & 16) ? 0xC0 : 0x40;
+			pixels[y * scanlength + x] = 0xFF000000 | (gray << 16) | (gray << 8) | gray;
+		}
+	}
+}
+
+int maOpenGLTexImage2D(MAHandle image)
+{
+	MAExtent size = maGetImageSize(image);
+	if(size == 0)
+	{
+		return -1;
+	}
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, EXTENT_X(size), EXTENT_Y(size), 0,
+		GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	return 0;
+}
+
+int maGetDataSize(MAHandle data)
+{
+	return 0;
+}
+
+void maReadData(MAHandle data, void *dst, int offset, int size)
+{
+	memset(dst, 0, size);
+}
+
+int lprintfln(const char *fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	int result = vprintf(fmt, args);
+	va_end(args);
+	printf("\n");
+	return result;
+}
+
+}
@@ -0,0 +1,50 @@
+/*
+ * GlView.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef HEADLESS_GLVIEW_H_
+#define HEADLESS_GLVIEW_H_
+
+#include "GlViewListener.h"
+
+namespace NativeUI
+{
+	/**
+	 * A GL view with a fixed size and no surface. addGLViewListener
+	 * reports the view ready straight away, redraw only counts.
+	 */
+	class GLView
+	{
+	public:
+		GLView(int width, int height):
+			mWidth(width),
+			mHeight(height),
+			mRedraws(0)
+		{
+		}
+
+		void addGLViewListener(GLViewListener *listener)
+		{
+			listener->glViewReady(this);
+		}
+
+		void bind() {}
+
+		void redraw() { mRedraws++; }
+
+		int getWidth() const { return mWidth; }
+
+		int getHeight() const { return mHeight; }
+
+		int getRedraws() const { return mRedraws; }
+
+	private:
+		int mWidth;
+		int mHeight;
+		int mRedraws;
+	};
+}
+
+#endif /* HEADLESS_GLVIEW_H_ */
@@ -0,0 +1,21 @@
+/*
+ * GlViewListener.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef HEADLESS_GLVIEWLISTENER_H_
+#define HEADLESS_GLVIEWLISTENER_H_
+
+namespace NativeUI
+{
+	class GLView;
+
+	class GLViewListener
+	{
+	public:
+		virtual void glViewReady(GLView *glView) = 0;
+	};
+}
+
+#endif /* HEADLESS_GLVIEWLISTENER_H_ */
@@ -0,0 +1,394 @@
+/*
+ * RendererBenchmark.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+// Runs the renderer on a desktop against GLRecorder and reports
+// what it submits per frame, so renderer changes can be measured
+// without a device. Build it with the host compiler, make -C headless,
+// the MoSync project excludes this directory.
+//
+// Usage: renderer_benchmark [--frames N] [--gles10] [--log FRAME]
+//        [--pixel-error E] [--float-vertices] [--particles N]
+//        [--resolution-scale S] [--altitude Z] [--no-occlusion]
+//        [--moving-sun] [--no-minimap] [--stats-overlay] [--textures N]
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include "GLRecorder.h"
+#include "MAHeaders.h"
+#include "../Renderer.h"
+#include "../MemoryTracker.h"
+
+// Same terrain as the application builds.
+#define NUM_SEGMENTS 100
+#define TEXTURE_REPEATS 10
+
+#define VIEW_WIDTH 480
+#define VIEW_HEIGHT 800
+
+// Texture budget of --textures: the atlas and a few of the
+// images too large for it fit, all of them don't.
+#define TEXTURE_BENCHMARK_BUDGET (1536 * 1024)
+
+static float getPointHeight(float x, float y)
+{
+	float freq = 0.03;
+	float value = (cos(y*freq*2*M_PI) + cos(x*freq*2*M_PI))/2;
+	return (value>0)?value:0;
+}
+
+static landscape* createLandscape()
+{
+	landscape *ls = new landscape;
+	ls->numSegments = NUM_SEGMENTS * NUM_SEGMENTS;
+	ls->segmentsPerSide = NUM_SEGMENTS;
+	ls->segments = new landSegment[ls->numSegments];
+
+	static const float baseVCoords[4][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+	static const float baseTCoords[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+	float segmentsPerTexture = (float)NUM_SEGMENTS / TEXTURE_REPEATS;
+	for(int x = 0; x < NUM_SEGMENTS; x++)
+	{
+		for(int y = 0; y < NUM_SEGMENTS; y++)
+		{
+			landSegment &segment = ls->segments[x * NUM_SEGMENTS + y];
+			for(int i = 0; i < 4; i++)
+			{
+				segment.vcoords[i][0] = 200.0f * ((x - NUM_SEGMENTS/2) * 2 + baseVCoords[i][0]) / NUM_SEGMENTS;
+				segment.vcoords[i][1] = 200.0f * ((y - NUM_SEGMENTS/2) * 2 + baseVCoords[i][1]) / NUM_SEGMENTS;
+				segment.vcoords[i][2] = 10.0f * getPointHeight(segment.vcoords[i][0], segment.vcoords[i][1]);
+				segment.tcoords[i][0] = ((x % TEXTURE_REPEATS) / segmentsPerTexture) + baseTCoords[i][0] / segmentsPerTexture;
+				segment.tcoords[i][1] = ((y % TEXTURE_REPEATS) / segmentsPerTexture) + baseTCoords[i][1] / segmentsPerTexture;
+			}
+			// Face normals of triangles 0 1 2 and 0 2 3.
+			memset(segment.distance, 0, sizeof(segment.distance));
+			for(int i = 0; i < 2; i++)
+			{
+				const float *p0 = segment.vcoords[0];
+				const float *p1 = segment.vcoords[1 + i];
+				const float *p2 = segment.vcoords[2 + i];
+				float v1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+				float v2[3] = {p2[0] - p1[0], p2[1] - p1[1], p2[2] - p1[2]};
+				vector n = {v1[1] * v2[2] - v1[2] * v2[1],
+					v1[2] * v2[0] - v1[0] * v2[2], v1[0] * v2[1] - v1[1] * v2[0]};
+				float length = sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+				segment.normalVector[i].x = n.x / length;
+				segment.normalVector[i].y = n.y / length;
+				segment.normalVector[i].z = n.z / length;
+			}
+		}
+	}
+	return ls;
+}
+
+/**
+ * The lander drifts across the terrain, descending and
+ * slowly tilting its view, like a typical approach.
+ */
+static float sAltitude = 0.0f;
+
+static void moveCamera(camera *c, int frame, int frames)
+{
+	float t = (float)frame / frames;
+	c->position.x = -150.0f + 300.0f * t;
+	c->position.y = 60.0f * sin(t * 2 * M_PI);
+	c->position.z = 40.0f - 25.0f * t;
+	c->facing.x = 0.3f * sin(t * 4 * M_PI);
+	c->facing.y = -0.95f * t;
+	c->facing.z = -1.0f;
+	// Or skim the hills, looking ahead.
+	if(sAltitude > 0.0f)
+	{
+		c->position.z = sAltitude;
+		c->facing.y = -0.95f;
+	}
+}
+
+static int microseconds()
+{
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	return (int)(now.tv_sec * 1000000 + now.tv_usec);
+}
+
+/**
+ * Keep a pool of the given size full of exhaust falling on the
+ * terrain, and time the update and draw of all of them.
+ */
+static void benchmarkParticles(landscape *ls, int capacity, int frames)
+{
+	ParticleSystem particles(capacity);
+	particles.setLandscape(ls);
+	GLStateCache state;
+	float position[3] = {0.0f, 0.0f, 30.0f};
+	float velocity[3] = {0.0f, 0.0f, -8.0f};
+	int updateTime = 0;
+	int drawTime = 0;
+	int live = 0;
+	for(int frame = 0; frame < frames; frame++)
+	{
+		particles.emit(PARTICLE_EXHAUST, position, velocity, 6.0f, capacity / 30);
+		int start = microseconds();
+		particles.update(1.0f / 60);
+		int updated = microseconds();
+		particles.draw(&state);
+		updateTime += updated - start;
+		drawTime += microseconds() - updated;
+		live += particles.getCount();
+	}
+	printf("particles: %d live on average, update %d us, pack and draw %d us per frame\n",
+		live / frames, updateTime / frames, drawTime / frames);
+}
+
+/**
+ * Register small images with a low budget, pack them, and bind
+ * a window of them that slides along every frame, so the atlases
+ * and the larger images keep getting evicted and loaded again.
+ * A charge like the minimap's stays resident throughout.
+ */
+static void benchmarkTextures(int count, int frames)
+{
+	count = (count > SMALL_IMAGE_COUNT) ? SMALL_IMAGE_COUNT : count;
+	GLStateCache state;
+	TextureManager textures(&state);
+	textures.setBudget(TEXTURE_BENCHMARK_BUDGET);
+	TextureHandle handles[SMALL_IMAGE_COUNT];
+	for(int i = 0; i < count; i++)
+	{
+		handles[i] = textures.acquire(SMALL_IMAGE_FIRST + i);
+		// A second owner that lets go must leave it registered.
+		TextureHandle again = textures.acquire(SMALL_IMAGE_FIRST + i);
+		if(again != handles[i])
+		{
+			printf("textures: image %d registered twice\n", i);
+		}
+		textures.release(again);
+	}
+	textures.packAtlases();
+	TextureHandle charge = textures.addExternal(MINIMAP_SIZE * MINIMAP_SIZE * 3);
+
+	int window = (count + 3) / 4;
+	int bindTime = 0;
+	int peakResident = 0;
+	for(int frame = 0; frame < frames; frame++)
+	{
+		textures.beginFrame();
+		int start = microseconds();
+		for(int i = 0; i < window; i++)
+		{
+			if(textures.bind(handles[(frame + i) % count]) == 0)
+			{
+				printf("textures: image %d did not load\n", (frame + i) % count);
+			}
+		}
+		bindTime += microseconds() - start;
+		int resident = textures.getResidentBytes();
+		peakResident = (resident > peakResident) ? resident : peakResident;
+	}
+	printf("textures: %d images, %d bound per frame, %d us per frame, "
+		"%d loads, %d evictions, %d/%d bytes peak/budget\n",
+		count, window, bindTime / frames, textures.getLoads(),
+		textures.getEvictions(), peakResident, TEXTURE_BENCHMARK_BUDGET);
+
+	for(int i = 0; i < count; i++)
+	{
+		textures.release(handles[i]);
+	}
+	int charged = textures.getResidentBytes();
+	textures.release(charge);
+	printf("textures: %d bytes resident with only the charge, %d after\n",
+		charged, textures.getResidentBytes());
+}
+
+int main(int argc, char **argv)
+{
+	int frames = 300;
+	int logFrame = -1;
+	float pixelError = TERRAIN_MAX_PIXEL_ERROR;
+	int particleCapacity = 0;
+	bool floatVertices = false;
+	float resolutionScale = 0.0f;
+	bool occlusion = true;
+	bool movingSun = false;
+	bool minimap = true;
+	bool statsOverlay = false;
+	int textureCount = 0;
+	for(int i = 1; i < argc; i++)
+	{
+		if(strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+		{
+			frames = atoi(argv[++i]);
+		}
+		else if(strcmp(argv[i], "--log") == 0 && i + 1 < argc)
+		{
+			logFrame = atoi(argv[++i]);
+		}
+		else if(strcmp(argv[i], "--pixel-error") == 0 && i + 1 < argc)
+		{
+			pixelError = atof(argv[++i]);
+		}
+		else if(strcmp(argv[i], "--particles") == 0 && i + 1 < argc)
+		{
+			particleCapacity = atoi(argv[++i]);
+		}
+		else if(strcmp(argv[i], "--resolution-scale") == 0 && i + 1 < argc)
+		{
+			resolutionScale = atof(argv[++i]);
+		}
+		else if(strcmp(argv[i], "--textures") == 0 && i + 1 < argc)
+		{
+			textureCount = atoi(argv[++i]);
+		}
+		else if(strcmp(argv[i], "--altitude") == 0 && i + 1 < argc)
+		{
+			sAltitude = atof(argv[++i]);
+		}
+		else if(strcmp(argv[i], "--moving-sun") == 0)
+		{
+			movingSun = true;
+		}
+		else if(strcmp(argv[i], "--stats-overlay") == 0)
+		{
+			statsOverlay = true;
+		}
+		else if(strcmp(argv[i], "--no-minimap") == 0)
+		{
+			minimap = false;
+		}
+		else if(strcmp(argv[i], "--no-occlusion") == 0)
+		{
+			occlusion = false;
+		}
+		else if(strcmp(argv[i], "--float-vertices") == 0)
+		{
+			floatVertices = true;
+		}
+		else if(strcmp(argv[i], "--gles10") == 0)
+		{
+			GLRecorder::setVersion("OpenGL ES-CM 1.0 GLRecorder");
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [--frames N] [--gles10] [--log FRAME] [--pixel-error E] [--float-vertices] [--particles N] [--resolution-scale S] [--altitude Z] [--no-occlusion] [--moving-sun] [--no-minimap] [--stats-overlay] [--textures N]\n", argv[0]);
+			return 1;
+		}
+	}
+	if(frames < 1)
+	{
+		frames = 1;
+	}
+
+	landscape *ls = createLandscape();
+	camera cam;
+	moveCamera(&cam, 0, frames);
+
+	GLView view(VIEW_WIDTH, VIEW_HEIGHT);
+	Renderer renderer;
+	renderer.init(&view);
+	renderer.setLandscape(ls);
+	renderer.setCamera(&cam);
+	renderer.setTerrainDetail(pixelError);
+	if(floatVertices)
+	{
+		renderer.setTerrainVertexFormat(TERRAIN_VERTEX_FLOAT);
+	}
+	renderer.setOcclusionCulling(occlusion);
+	renderer.setMinimapVisible(minimap);
+	renderer.setStatsOverlayVisible(statsOverlay);
+	// Frames take no time here, so pin the scale to measure it.
+	if(resolutionScale > 0.0f)
+	{
+		renderer.getResolution().setBounds(resolutionScale, resolutionScale);
+	}
+
+	glCounters sum;
+	memset(&sum, 0, sizeof(sum));
+	int cpuTime = 0;
+	int worstTime = 0;
+	int drawnChunks = 0;
+	int occludedChunks = 0;
+	// As the renderer counted them itself.
+	renderFrameStats counted;
+	memset(&counted, 0, sizeof(counted));
+	printf("frame calls draws vertices state redundant bytesRef bytesUp drawn culled hidden us\n");
+	for(int frame = 0; frame < frames; frame++)
+	{
+		moveCamera(&cam, frame, frames);
+		// Relights the whole terrain every frame, the worst case.
+		if(movingSun)
+		{
+			vector sun = {cos(frame * 0.05f), sin(frame * 0.05f), 1.0f};
+			renderer.setSun(sun, TERRAIN_AMBIENT);
+		}
+		GLRecorder::beginFrame();
+		GLRecorder::setLogging(frame == logFrame);
+
+		int start = microseconds();
+		renderer.draw();
+		int time = microseconds() - start;
+
+		const glCounters &c = GLRecorder::getFrameCounters();
+		printf("%5d %5d %5d %8d %5d %9d %8d %7d %5d %6d %6d %d\n", frame,
+			c.calls, c.drawCalls, c.vertices, c.stateChanges,
+			c.redundantStateChanges, c.bytesReferenced, c.bytesUploaded,
+			renderer.getDrawnChunks(), renderer.getCulledChunks(),
+			renderer.getOccludedChunks(), time);
+		if(frame == logFrame)
+		{
+			GLRecorder::dumpLog(stdout);
+		}
+
+		sum.calls += c.calls;
+		sum.drawCalls += c.drawCalls;
+		sum.vertices += c.vertices;
+		sum.stateChanges += c.stateChanges;
+		sum.redundantStateChanges += c.redundantStateChanges;
+		sum.bytesReferenced += c.bytesReferenced;
+		cpuTime += time;
+		worstTime = (time > worstTime) ? time : worstTime;
+		drawnChunks += renderer.getDrawnChunks();
+		occludedChunks += renderer.getOccludedChunks();
+		const renderFrameStats &last = renderer.getStats().getLast();
+		counted.drawCalls += last.drawCalls;
+		counted.vertices += last.vertices;
+		counted.indices += last.indices;
+		counted.textureBinds += last.textureBinds;
+	}
+
+	printf("\naverage per frame over %d frames:\n", frames);
+	printf("  GL calls            %d\n", sum.calls / frames);
+	printf("  draw calls          %d\n", sum.drawCalls / frames);
+	printf("  vertices            %d\n", sum.vertices / frames);
+	printf("  state changes       %d (%d redundant)\n",
+		sum.stateChanges / frames, sum.redundantStateChanges / frames);
+	printf("  bytes referenced    %d\n", sum.bytesReferenced / frames);
+	printf("  chunks drawn        %d.%d (%d.%d occluded)\n",
+		drawnChunks / frames, drawnChunks * 10 / frames % 10,
+		occludedChunks / frames, occludedChunks * 10 / frames % 10);
+	printf("  eliminated by cache %d\n", renderer.getEliminatedStateChanges() / frames);
+	printf("  renderer statistics %d draws, %d vertices, %d indices, %d texture binds\n",
+		counted.drawCalls / frames, counted.vertices / frames,
+		counted.indices / frames, counted.textureBinds / frames);
+	printf("  CPU time            %d us (worst %d us)\n", cpuTime / frames, worstTime);
+	printf("setup uploads         %d bytes\n", GLRecorder::getTotalCounters().bytesUploaded);
+	printf("textures resident     %d bytes\n", renderer.getTextures().getResidentBytes());
+	printf("heap live/peak        %d/%d bytes\n",
+		MemoryTracker::getTotalStats().liveBytes, MemoryTracker::getTotalStats().peakBytes);
+
+	if(particleCapacity > 0)
+	{
+		benchmarkParticles(ls, particleCapacity, frames);
+	}
+	if(textureCount > 0)
+	{
+		benchmarkTextures(textureCount, frames);
+	}
+
+	renderer.setLandscape(NULL);
+	delete[] ls->segments;
+	delete ls;
+	return 0;
+}
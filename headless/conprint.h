@@ -0,0 +1,17 @@
+/*
+ * conprint.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef HEADLESS_CONPRINT_H_
+#define HEADLESS_CONPRINT_H_
+
+#include "ma.h"
+
+#ifdef __cplusplus
+extern "C"
+#endif
+int lprintfln(const char *fmt, ...);
+
+#endif /* HEADLESS_CONPRINT_H_ */
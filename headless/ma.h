@@ -0,0 +1,50 @@
+/*
+ * ma.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef HEADLESS_MA_H_
+#define HEADLESS_MA_H_
+
+/**
+ * The part of the MoSync syscall API the renderer uses, for
+ * building it against GLRecorder on a desktop. Implemented
+ * in MoSyncStubs.cpp.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+typedef int MAHandle;
+typedef int MAExtent;
+
+typedef struct MARect{
+	int left;
+	int top;
+	int width;
+	int height;
+} MARect;
+
+#define EXTENT_X(e) ((int)(((unsigned int)(e)) >> 16))
+#define EXTENT_Y(e) ((int)(((unsigned int)(e)) & 0xFFFF))
+#define EXTENT(x, y) ((MAExtent)((((int)(x)) << 16) | ((y) & 0xFFFF)))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int maGetMilliSecondCount(void);
+void maPanic(int result, const char *message);
+MAExtent maGetImageSize(MAHandle image);
+void maGetImageData(MAHandle image, void *dst, const MARect *srcRect, int scanlength);
+int maOpenGLTexImage2D(MAHandle image);
+int maGetDataSize(MAHandle data);
+void maReadData(MAHandle data, void *dst, int offset, int size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HEADLESS_MA_H_ */
@@ -0,0 +1,13 @@
+/*
+ * madmath.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef HEADLESS_MADMATH_H_
+#define HEADLESS_MADMATH_H_
+
+#include <math.h>
+#include "ma.h"
+
+#endif /* HEADLESS_MADMATH_H_ */
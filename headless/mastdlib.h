@@ -0,0 +1,13 @@
+/*
+ * mastdlib.h
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#ifndef HEADLESS_MASTDLIB_H_
+#define HEADLESS_MASTDLIB_H_
+
+#include <math.h>
+#include "ma.h"
+
+#endif /* HEADLESS_MASTDLIB_H_ */
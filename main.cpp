@@ -1,5 +1,6 @@
 #include <ma.h>
 #include <mavsprintf.h>
+#include <conprint.h>
 #include <MAFS/File.h>
 #include <MAUtil/Moblet.h>
 #include <NativeUI/Widgets.h>
@@ -9,6 +10,10 @@
 #include "LuaEngine.h"
 #include "Renderer.h"
 #include "BundleDownloader.h"
+#include "Telemetry.h"
+#include "JobSystem.h"
+#include "MemoryTracker.h"
+#include "RenderLoop.h"
 
 using namespace MAUtil;
 using namespace NativeUI;
@@ -21,6 +26,8 @@ using namespace NativeUI;
 #define LANDING_SPEED 1.0f
 #define LANDING_DEVIATION 0.3f
 #define LABEL_UPDATE_PER 0.3f
+// Milliseconds between timer events.
+#define TIMER_PERIOD 10
 
 
 // A simple low pass filter used to
@@ -58,7 +65,7 @@ struct LowPassFilter {
 /**
  * Moblet to be used as a template for a Native UI application.
  */
-class NativeUIMoblet : public Moblet, public SensorListener, public TimerListener, public BundleListener
+class NativeUIMoblet : public Moblet, public SensorListener, public TimerListener, public BundleListener, public MemoryBudgetListener, public FrameIdleListener, public JobListener
 {
 public:
 	/**
@@ -66,7 +73,11 @@ public:
 	 */
 	NativeUIMoblet()
 	{
-		mDownloader = new BundleDownloader(this);
+		MemoryTracker::setBudget(MEMORY_DEFAULT_BUDGET, this);
+		{
+			MemoryTagScope scope(MEMTAG_NET);
+			mDownloader = new BundleDownloader(this);
+		}
 		initialize();
 	}
 
@@ -75,6 +86,8 @@ public:
 	 */
 	virtual ~NativeUIMoblet()
 	{
+		mRenderLoop.stop();
+		mTelemetry.stop();
 		// All the children will be deleted.
 		delete mScreen;
 	}
@@ -84,11 +97,14 @@ public:
 		mPrevTime = maGetMilliSecondCount();
 		initLua();
 		createUI();
-		mRenderer.init(mGLView);
-		mCamera = new camera;
-		mRenderer.setCamera(mCamera);
+		{
+			MemoryTagScope scope(MEMTAG_RENDER);
+			mRenderer.init(mGLView);
+			mCamera = new camera;
+		}
+		// Scripts can ask what rendering costs.
+		SetLuaRenderStats(&mRenderer.getStats());
 		createLandscape();
-		mRenderer.setLandscape(mLandscape);
 		mPosition.x = 0;
 		mPosition.y = 0;
 		mPosition.z = 40;
@@ -110,14 +126,25 @@ public:
 		mFacing.x=0;
 		mFacing.y=0;
 		mFacing.z = -1;
-		Environment::getEnvironment().addTimer(this,10,0);
+		mCamera->position = mPosition;
+		mCamera->facing = mFacing;
+		mTelemetry.start(mLocalPath + "telemetry.bin");
+		Environment::getEnvironment().addTimer(this,TIMER_PERIOD,0);
+		// Frames are drawn on their own timer from the
+		// scenes runTimerEvent publishes.
+		mRenderLoop.setIdleListener(this);
+		mRenderLoop.start(&mRenderer);
 		Environment::getEnvironment().addSensorListener(this);
 		maSensorStart(1, -1);
 	}
 
 	void initLua()
 	{
+		MemoryTagScope scope(MEMTAG_LUA);
 		exractBin(LOCAL_FILES_BIN);
+		// Keep the interpreter's small blocks in slabs, away
+		// from the rest of the heap.
+		mLua.setPooledAllocator(true);
 		if (!mLua.initialize())
 		{
 			maPanic(0,"Lua engine failed to initialize");
@@ -125,6 +152,9 @@ public:
 		String initScript;
 		readTextFromFile("Init.lua",initScript);
 		mLua.eval(initScript.c_str());
+		// From here on garbage is collected at the end of each
+		// drawn frame, not in the middle of whatever allocates.
+		mLua.setAllocationGC(false);
 	}
 
 	void exractBin(MAHandle bin)
@@ -159,7 +189,7 @@ public:
 		}
 
 		// Allocate buffer with space for a null termination character.
-		char* buffer = (char*) malloc(sizeof(char) * (size + 1));
+		char* buffer = (char*) memAlloc(sizeof(char) * (size + 1), MEMTAG_LUA);
 
 		int result = maFileRead(file, buffer, size);
 
@@ -167,6 +197,7 @@ public:
 
 		buffer[size] = 0;
 		inText = buffer;
+		memFree(buffer);
 
 		return result == 0;
 	}
@@ -181,6 +212,7 @@ public:
 	 */
 	void createUI()
 	{
+		MemoryTagScope scope(MEMTAG_UI);
 		MAExtent ex = maGetScrSize();
 		int screenWidth = EXTENT_X(ex);
 		int screenHeight = EXTENT_Y(ex);
@@ -190,7 +222,7 @@ public:
 		mLabel = new Label();
 		mLabel->fillSpaceHorizontally();
 		mLabel->fillSpaceVertically();
-		mLabel->setMaxNumberOfLines(4);
+		mLabel->setMaxNumberOfLines(5);
 		mLabel->setFontSize(12);
 		//The widget that renders the animation
 		mGLView = new GLView(MAW_GL_VIEW);
@@ -210,14 +242,60 @@ public:
 		mScreen->show();
 	}
 
+	/**
+	 * Builds a range of landscape rows.
+	 */
+	class LandscapeJob : public ParallelForJob
+	{
+	public:
+		LandscapeJob(NativeUIMoblet *moblet) :
+			ParallelForJob(0, NUM_SEGMENTS),
+			mMoblet(moblet)
+		{
+		}
+
+		void runRange(int begin, int end)
+		{
+			mMoblet->createLandscapeRows(begin, end);
+		}
+
+	private:
+		NativeUIMoblet *mMoblet;
+	};
+
 	void createLandscape()
 	{
-		GLfloat baseVCoords[4][3];
-		GLfloat baseTCoords[4][2];
+		MemoryTagScope scope(MEMTAG_TERRAIN);
 		mLandscape = new landscape;
 		mLandscape->numSegments = NUM_SEGMENTS*NUM_SEGMENTS;
+		mLandscape->segmentsPerSide = NUM_SEGMENTS;
 		mLandscape->segments = new landSegment[mLandscape->numSegments];
 
+		// The rows don't depend on each other, so let the job
+		// system build them in idle time. The renderer gets the
+		// landscape once they are all done, see jobCompleted().
+		mLandscapeJob = new LandscapeJob(this);
+		JobSystem::getJobSystem().submit(mLandscapeJob, this);
+	}
+
+	/**
+	 * The landscape is built, start drawing it.
+	 */
+	void jobCompleted(Job *job)
+	{
+		if(job == mLandscapeJob)
+		{
+			delete mLandscapeJob;
+			mLandscapeJob = NULL;
+			mRenderer.setLandscape(mLandscape);
+		}
+	}
+
+	void createLandscapeRows(int begin, int end)
+	{
+		GLfloat baseVCoords[4][3];
+		GLfloat baseTCoords[4][2];
+
 		baseTCoords[0][0] = 0.0f;  baseTCoords[0][1] = 0.0f;
 		baseVCoords[0][0] = -1.0f; baseVCoords[0][1] = -1.0f; baseVCoords[0][2] = 0.0f;
 		baseTCoords[1][0] = 1.0f;  baseTCoords[1][1] = 0.0f;
@@ -228,9 +306,9 @@ public:
 		baseVCoords[3][0] = -1.0f; baseVCoords[3][1] = 1.0f; baseVCoords[3][2] = 0.0f;
 
 		float segmentsPerTexture = (float)NUM_SEGMENTS / TEXTURE_REPEATS;
-		int j = 0;
-		for(int x = 0; x < NUM_SEGMENTS; x++)
+		for(int x = begin; x < end; x++)
 		{
+			int j = x * NUM_SEGMENTS;
 			for(int y = 0; y < NUM_SEGMENTS; y++)
 			{
 				for(int i = 0; i < 4; i++)
@@ -342,26 +420,53 @@ public:
 		{
 			//Get the current system time
 			int currentTime = maGetMilliSecondCount();
+			// Hold the lander still until there is ground to
+			// collide with, see createLandscape().
+			if(mLandscapeJob != NULL)
+			{
+				publishScene(currentTime);
+				mPrevTime = currentTime;
+				return;
+			}
 			float period = (currentTime-mPrevTime)/1000.0f;
 			calculateAcceleration(period);
 			calculatePosition(period);
 			//Calculate and draw the positions for the new frame
 			checkCollision();
-			mRenderer.draw();
+			mTelemetry.record(currentTime, mPosition, mVelocity, mFacing, mAltitude, period, mEnginesRunning);
+			publishScene(currentTime);
 			mSecondsSinceLastUpdate += period;
 			if(mSecondsSinceLastUpdate > LABEL_UPDATE_PER)
 			{
 				mSecondsSinceLastUpdate = 0;
-				char buffer[256];
+				char buffer[512];
 				sprintf(buffer,
-				" Position - x:%f, y:%f, z:%f\n Speed - x:%f, y:%f, z:%f\n Absolute speed:%f, altitude:%f\n Segment - x:%d, y:%d, x:%4.5f, y:%4.5f, z:%4.5f",
-						mPosition.x,mPosition.y,mPosition.z,mVelocity.x,mVelocity.y,mVelocity.z,mAbsSpeed,mAltitude,mX,mY,mNormal.x,mNormal.y,mNormal.z);
+				" Position - x:%f, y:%f, z:%f\n Speed - x:%f, y:%f, z:%f\n Absolute speed:%f, altitude:%f\n Segment - x:%d, y:%d, x:%4.5f, y:%4.5f, z:%4.5f\n Chunks - drawn:%d, culled:%d, hidden:%d, resolution:%.2f\n Frame - fps:%.1f, p90:%dms, draws:%d, vertices:%d",
+						mPosition.x,mPosition.y,mPosition.z,mVelocity.x,mVelocity.y,mVelocity.z,mAbsSpeed,mAltitude,mX,mY,mNormal.x,mNormal.y,mNormal.z,
+						mRenderer.getDrawnChunks(),mRenderer.getCulledChunks(),mRenderer.getOccludedChunks(),mRenderer.getResolutionScale(),
+						mRenderer.getStats().getFPS(),mRenderer.getStats().getFrameTimePercentile(90),
+						mRenderer.getStats().getLast().drawCalls,mRenderer.getStats().getLast().vertices);
 				mLabel->setText(buffer);
+				MemoryTracker::sample();
 			}
 			mPrevTime = currentTime;
 		}
 	}
 
+	/**
+	 * Hand a copy of what the renderer needs to the render loop.
+	 */
+	void publishScene(int time)
+	{
+		sceneSnapshot &scene = mRenderLoop.beginScene();
+		scene.time = time;
+		scene.view = *mCamera;
+		scene.landerPosition = mPosition;
+		scene.landerVelocity = mVelocity;
+		scene.enginesRunning = mEnginesRunning;
+		mRenderLoop.publishScene();
+	}
+
 	void calculateAcceleration(float period)
 	{
 		float enginePower;
@@ -459,6 +564,20 @@ public:
 
 
 
+	void memoryBudgetExceeded(int liveBytes, int budget)
+	{
+		lprintfln("Memory budget exceeded: %d of %d bytes live", liveBytes, budget);
+		MemoryTracker::dump();
+	}
+
+	/**
+	 * Collect Lua garbage in what is left of a drawn frame.
+	 */
+	void frameIdle(int microseconds)
+	{
+		mLua.collectGarbage(microseconds);
+	}
+
 	virtual void pointerPressEvent(MAPoint2d p)
 	{
 		mEnginesRunning = true;
@@ -480,6 +599,7 @@ private:
     int mPrevTime;
 
     landscape *mLandscape;
+    LandscapeJob *mLandscapeJob;
     vector mVelocity;
     vector mPosition;
     vector mGravity;
@@ -491,9 +611,11 @@ private:
     MobileLua::LuaEngine mLua;
     String mLocalPath;
     Renderer mRenderer;
+    RenderLoop mRenderLoop;
     camera *mCamera;
 
     BundleDownloader *mDownloader;
+    TelemetryLogger mTelemetry;
 };
 
 /**